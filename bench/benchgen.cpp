@@ -0,0 +1,314 @@
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "aiger.h"
+
+namespace {
+
+using lits = std::vector<unsigned>;
+
+// A circuit under construction. All inputs and latches have to be allocated
+// before the first and, so the circuit is reencoded when written.
+struct circuit {
+  aiger *aig{aiger_init()};
+  unsigned next_lit{2};
+  std::vector<std::array<unsigned, 3>> latch; // lit, next, reset
+
+  lits inputs(unsigned n) {
+    lits l(n);
+    for (unsigned &i : l) {
+      aiger_add_input(aig, i = next_lit, nullptr);
+      next_lit += 2;
+    }
+    return l;
+  }
+  // Latches start uninitialized and without next state function.
+  lits latches(unsigned n) {
+    lits l(n);
+    for (unsigned &i : l) {
+      latch.push_back({i = next_lit, 0, next_lit});
+      next_lit += 2;
+    }
+    return l;
+  }
+  std::array<unsigned, 3> &defined(unsigned l) {
+    return latch[l / 2 - 1 - aig->num_inputs];
+  }
+  void define(unsigned l, unsigned next, unsigned reset) {
+    defined(l) = {l, next, reset};
+  }
+  unsigned conj(unsigned s, unsigned t) {
+    if (!s || !t || s == aiger_not(t)) return 0;
+    if (s == 1 || s == t) return t;
+    if (t == 1) return s;
+    aiger_add_and(aig, next_lit, s, t);
+    return (next_lit += 2) - 2;
+  }
+  unsigned disj(unsigned s, unsigned t) {
+    return aiger_not(conj(aiger_not(s), aiger_not(t)));
+  }
+  unsigned imply(unsigned s, unsigned t) { return disj(aiger_not(s), t); }
+  unsigned equal(unsigned s, unsigned t) {
+    return conj(imply(s, t), imply(t, s));
+  }
+  unsigned all(const lits &l) {
+    unsigned r{1};
+    for (unsigned x : l) r = conj(r, x);
+    return r;
+  }
+  unsigned any(const lits &l) {
+    unsigned r{0};
+    for (unsigned x : l) r = disj(r, x);
+    return r;
+  }
+  void comment(const std::string &line) {
+    aiger_add_comment(aig, line.c_str());
+  }
+  void write(const char *path) {
+    for (auto [l, next, reset] : latch) {
+      aiger_add_latch(aig, l, next, nullptr);
+      aiger_add_reset(aig, l, reset);
+    }
+    std::cout << path << ": " << aig->num_inputs << " inputs "
+              << aig->num_latches << " latches " << aig->num_ands << " ands\n";
+    if (!aiger_open_and_write_to_file(aig, path))
+      std::cerr << "Error writing " << path << "\n", exit(1);
+    aiger_reset(aig);
+  }
+};
+
+// k-induction: `width` rings of `depth` latches, each stage cleared by the
+// input of its ring. The last stages are never set, which is depth-inductive
+// but not (depth-1)-inductive. The witness keeps depth-1 previous states
+// and inputs with valid bits and requires the history to be a path that
+// starts in a reset state unless it is full (Yu et al. FMCAD22).
+void kind(unsigned depth, unsigned width, const char *model_path,
+          const char *witness_path) {
+  auto transition = [&](circuit &c, const lits &state, const lits &input) {
+    lits next(state.size());
+    for (unsigned r = 0; r < width; ++r)
+      for (unsigned i = 0; i < depth; ++i)
+        next[r * depth + (i + 1) % depth] =
+            i + 1 == depth ? state[r * depth + i]
+                           : c.conj(state[r * depth + i], aiger_not(input[r]));
+    return next;
+  };
+  auto bad = [&](circuit &c, const lits &state) {
+    lits last;
+    for (unsigned r = 0; r < width; ++r)
+      last.push_back(state[r * depth + depth - 1]);
+    return c.any(last);
+  };
+  auto reset = [](circuit &c, const lits &state) {
+    lits zero;
+    for (unsigned l : state) zero.push_back(aiger_not(l));
+    return c.all(zero);
+  };
+
+  circuit m;
+  const lits x = m.inputs(width), s = m.latches(width * depth);
+  const lits n = transition(m, s, x);
+  for (unsigned i = 0; i < s.size(); ++i) m.define(s[i], n[i], 0);
+  aiger_add_bad(m.aig, bad(m, s), nullptr);
+  m.write(model_path);
+
+  circuit w;
+  const lits wx = w.inputs(width);
+  std::vector<lits> S{w.latches(width * depth)}, X{wx};
+  lits v{1};
+  for (unsigned i = 1; i < depth; ++i) {
+    S.push_back(w.latches(width * depth));
+    X.push_back(w.latches(width));
+    v.push_back(w.latches(1)[0]);
+  }
+  const lits wn = transition(w, S[0], wx);
+  for (unsigned l = 0; l < S[0].size(); ++l) w.define(S[0][l], wn[l], 0);
+  for (unsigned i = 1; i < depth; ++i) {
+    for (unsigned l = 0; l < S[i].size(); ++l)
+      w.define(S[i][l], S[i - 1][l], 0);
+    for (unsigned l = 0; l < X[i].size(); ++l)
+      w.define(X[i][l], X[i - 1][l], 0);
+    w.define(v[i], v[i - 1], 0);
+  }
+  unsigned invariant = aiger_not(bad(w, S[0]));
+  for (unsigned i = 1; i < depth; ++i) {
+    const lits step = transition(w, S[i], X[i]);
+    unsigned path = aiger_not(bad(w, S[i]));
+    for (unsigned l = 0; l < step.size(); ++l)
+      path = w.conj(path, w.equal(step[l], S[i - 1][l]));
+    invariant = w.conj(invariant, w.imply(v[i], path));
+    if (i + 1 < depth)
+      invariant = w.conj(invariant, w.imply(v[i + 1], v[i]));
+  }
+  // the oldest valid state of a partial history is a reset state
+  for (unsigned i = 0; i + 1 < depth; ++i) {
+    const unsigned oldest = w.conj(v[i], aiger_not(v[i + 1]));
+    invariant = w.conj(invariant, w.imply(oldest, reset(w, S[i])));
+  }
+  aiger_add_bad(w.aig, aiger_not(invariant), nullptr);
+  w.write(witness_path);
+}
+
+// Retiming: `width` channels, each a pipeline of `depth` latches fed by a
+// gate over two neighboring inputs. Neighboring gates are never both set.
+// The witness moves the latches before the gates, which turns the property
+// into a tautology, and maps the model latches to its gates with a MAPPING
+// comment.
+void retime(unsigned depth, unsigned width, const char *model_path,
+            const char *witness_path) {
+  auto gate = [&](circuit &c, const lits &x, unsigned j) {
+    return c.conj(x[j], aiger_not(x[(j + 1) % width]));
+  };
+  auto bad = [&](circuit &c, const lits &stage) {
+    lits overlap;
+    for (unsigned i = 0; i < depth; ++i)
+      for (unsigned j = 0; j < width; ++j)
+        overlap.push_back(c.conj(stage[j * depth + i],
+                                 stage[(j + 1) % width * depth + i]));
+    return c.any(overlap);
+  };
+
+  circuit m;
+  const lits x = m.inputs(width), r = m.latches(width * depth);
+  for (unsigned j = 0; j < width; ++j)
+    for (unsigned i = 0; i < depth; ++i)
+      m.define(r[j * depth + i], i ? r[j * depth + i - 1] : gate(m, x, j), 0);
+  aiger_add_bad(m.aig, bad(m, r), nullptr);
+  m.write(model_path);
+
+  circuit w;
+  const lits wx = w.inputs(width), s = w.latches(width * depth);
+  for (unsigned j = 0; j < width; ++j)
+    for (unsigned i = 0; i < depth; ++i)
+      w.define(s[j * depth + i], i ? s[j * depth + i - 1] : wx[j], 0);
+  lits g(width * depth);
+  for (unsigned i = 0; i < depth; ++i) {
+    lits stage(width);
+    for (unsigned j = 0; j < width; ++j) stage[j] = s[j * depth + i];
+    for (unsigned j = 0; j < width; ++j) g[j * depth + i] = gate(w, stage, j);
+  }
+  aiger_add_bad(w.aig, bad(w, g), nullptr);
+  w.comment("MAPPING " + std::to_string(width + g.size()));
+  for (unsigned j = 0; j < width; ++j)
+    w.comment(std::to_string(wx[j]) + " " + std::to_string(x[j]));
+  for (unsigned l = 0; l < g.size(); ++l)
+    w.comment(std::to_string(g[l]) + " " + std::to_string(r[l]));
+  w.write(witness_path);
+}
+
+// Liveness: `width` saturating counters of `depth` bits that may only count
+// on every other step, driven by a phase latch. The justice property is an
+// increment, which happens finitely often. The witness ranks the counters by
+// comparing the next-state functions with the current values and declares
+// the next-state functions of the counter bits with an INTERVENTION comment.
+void live(unsigned depth, unsigned width, const char *model_path,
+          const char *witness_path) {
+  // Defines the latches, returns the literal for an increment
+  auto counters = [&](circuit &c, const lits &inc, unsigned phase,
+                      const lits &bits) {
+    c.define(phase, aiger_not(phase), 0);
+    lits enabled;
+    for (unsigned j = 0; j < width; ++j) {
+      const lits counter(bits.begin() + j * depth,
+                         bits.begin() + (j + 1) * depth);
+      unsigned carry =
+          c.conj(c.conj(phase, inc[j]), aiger_not(c.all(counter)));
+      enabled.push_back(carry);
+      for (unsigned b = 0; b < depth; ++b) {
+        c.define(counter[b], aiger_not(c.equal(counter[b], carry)), 0);
+        carry = c.conj(carry, counter[b]);
+      }
+    }
+    return c.any(enabled);
+  };
+
+  circuit m;
+  const lits inc = m.inputs(width);
+  const unsigned phase = m.latches(1)[0];
+  const lits bits = m.latches(width * depth);
+  unsigned increment = counters(m, inc, phase, bits);
+  aiger_add_justice(m.aig, 1, &increment, nullptr);
+  m.write(model_path);
+
+  circuit w;
+  const lits winc = w.inputs(width);
+  const unsigned wphase = w.latches(1)[0];
+  const lits wbits = w.latches(width * depth);
+  counters(w, winc, wphase, wbits);
+  lits greater;
+  for (unsigned j = 0; j < width; ++j) {
+    unsigned gt{0};
+    for (unsigned b = 0; b < depth; ++b) {
+      const unsigned l = wbits[j * depth + b];
+      const unsigned next = w.defined(l)[1];
+      gt = w.disj(w.conj(next, aiger_not(l)), w.conj(w.equal(next, l), gt));
+    }
+    greater.push_back(gt);
+  }
+  unsigned ranked = w.any(greater);
+  aiger_add_justice(w.aig, 1, &ranked, nullptr);
+  w.comment("INTERVENTION " + std::to_string(wbits.size()));
+  for (unsigned l : wbits)
+    w.comment(std::to_string(l) + " " + std::to_string(w.defined(l)[1]));
+  w.write(witness_path);
+}
+
+// Reset functions: `width` chains of `depth` latches rotating their values.
+// Each chain starts in an arbitrary value copied down the chain by reset
+// functions pointing to gates over the previous latch. The witness copies
+// the previous latch directly, the property that neighbors are equal is
+// inductive.
+void reset(unsigned depth, unsigned width, const char *model_path,
+           const char *witness_path) {
+  auto chains = [&](circuit &c, const lits &l, bool gates) {
+    for (unsigned j = 0; j < width; ++j)
+      for (unsigned i = 0; i < depth; ++i) {
+        const unsigned p = (i + depth - 1) % depth;
+        const unsigned previous = l[j * depth + p];
+        const unsigned neighbor = l[(j + 1) % width * depth + p];
+        const unsigned copy =
+            gates ? c.conj(previous, c.disj(previous, neighbor)) : previous;
+        c.define(l[j * depth + i], previous, i ? copy : l[j * depth + i]);
+      }
+    lits differ;
+    for (unsigned j = 0; j < width; ++j)
+      for (unsigned i = 0; i + 1 < depth; ++i)
+        differ.push_back(
+            aiger_not(c.equal(l[j * depth + i], l[j * depth + i + 1])));
+    aiger_add_bad(c.aig, c.any(differ), nullptr);
+  };
+  circuit m;
+  chains(m, m.latches(width * depth), true);
+  m.write(model_path);
+  circuit w;
+  chains(w, w.latches(width * depth), false);
+  w.write(witness_path);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  using generator = void (*)(unsigned, unsigned, const char *, const char *);
+  const std::array<std::pair<std::string_view, generator>, 4> families{
+      {{"kind", kind}, {"retime", retime}, {"live", live}, {"reset", reset}}};
+  auto number = [](std::string_view arg) {
+    unsigned n{};
+    const auto [ptr, err] = std::from_chars(arg.begin(), arg.end(), n);
+    if (err != std::errc() || ptr != arg.end() || !n)
+      std::cerr << "Invalid size '" << arg << "'\n", exit(1);
+    return n;
+  };
+  if (argc == 6)
+    for (const auto &[name, generate] : families)
+      if (name == argv[1])
+        return generate(number(argv[2]), number(argv[3]), argv[4], argv[5]), 0;
+  std::cerr << "Usage: " << argv[0]
+            << " kind|retime|live|reset depth width model witness\n";
+  return 1;
+}
@@ -1,3 +1,4 @@
+include_guard(GLOBAL)
 include(ExternalProject)
 set(CADICAL_GIT_TAG "master" CACHE STRING "CaDiCaL git commit hash or tag to checkout")
 
@@ -20,10 +21,6 @@ else()
   )
 endif()
 
-set(CADICAL_DIR ${CMAKE_BINARY_DIR}/cadical-prefix/src/cadical)
-set(CADICAL_INCLUDE_DIR ${CADICAL_DIR}/src)
-set(CADICAL_LIB ${CADICAL_DIR}/build/libcadical.a)
-
 ExternalProject_Add(
   cadical
   ${_cadical_source_args}
@@ -31,5 +28,9 @@ ExternalProject_Add(
   BUILD_COMMAND make -j
   BUILD_IN_SOURCE 1
   UPDATE_COMMAND ""
+  BUILD_BYPRODUCTS <SOURCE_DIR>/build/libcadical.a
   INSTALL_COMMAND cp build/cadical ${CMAKE_CURRENT_BINARY_DIR})
 install(PROGRAMS ${CMAKE_CURRENT_BINARY_DIR}/cadical TYPE BIN)
+ExternalProject_Get_Property(cadical SOURCE_DIR)
+set(CADICAL_INCLUDE_DIR ${SOURCE_DIR}/src)
+set(CADICAL_LIB ${SOURCE_DIR}/build/libcadical.a)
@@ -1,3 +1,4 @@
+include_guard(GLOBAL)
 include(ExternalProject)
 if(STATIC)
   set(KISSAT_CONFIGURE_COMMAND ./configure -static)
@@ -23,5 +24,9 @@ ExternalProject_Add(
   UPDATE_COMMAND ""
   CONFIGURE_COMMAND ${KISSAT_CONFIGURE_COMMAND}
   BUILD_COMMAND make -j
+  BUILD_BYPRODUCTS <SOURCE_DIR>/build/libkissat.a
   INSTALL_COMMAND cp build/kissat ${CMAKE_CURRENT_BINARY_DIR})
 install(PROGRAMS ${CMAKE_CURRENT_BINARY_DIR}/kissat TYPE BIN)
+ExternalProject_Get_Property(kissat SOURCE_DIR)
+set(KISSAT_INCLUDE_DIR ${SOURCE_DIR}/src)
+set(KISSAT_LIB ${SOURCE_DIR}/build/libkissat.a)
@@ -0,0 +1,154 @@
+#include "cache.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr unsigned NONE = ~0u; // marks inputs in the description
+
+std::uint64_t mix(std::uint64_t x) {
+  x ^= x >> 30, x *= 0xbf58476d1ce4e5b9;
+  x ^= x >> 27, x *= 0x94d049bb133111eb;
+  return x ^ x >> 31;
+}
+
+// FNV-1a, which unlike std::hash is the same for every build.
+std::uint64_t fnv(const std::string &s) {
+  std::uint64_t h{0xcbf29ce484222325};
+  for (char c : s) h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+  return h;
+}
+
+fs::path entry(const char *dir, const std::string &cone) {
+  char name[32];
+  std::snprintf(name, sizeof name, "%016llx.cone",
+                static_cast<unsigned long long>(fnv(cone)));
+  return fs::path{dir} / name;
+}
+
+} // namespace
+
+std::string describe_cone(const aiger *circuit, unsigned lit) {
+  const unsigned n = circuit->maxvar + 1;
+  std::vector<unsigned> gate(n, NONE); // index of the and defining a variable
+  std::vector<bool> in_cone(n);
+  in_cone[aiger_lit2var(lit)] = true;
+  for (unsigned i = circuit->num_ands; i-- > 0;) {
+    const aiger_and *a = circuit->ands + i;
+    gate[aiger_lit2var(a->lhs)] = i;
+    if (!in_cone[aiger_lit2var(a->lhs)]) continue;
+    in_cone[aiger_lit2var(a->rhs0)] = true;
+    in_cone[aiger_lit2var(a->rhs1)] = true;
+  }
+
+  // structural hashes, equal for all inputs
+  std::vector<std::uint64_t> hash(n, 1);
+  hash[0] = 0;
+  auto child = [&hash](unsigned l) {
+    return mix(hash[aiger_lit2var(l)] + aiger_sign(l));
+  };
+  for (unsigned i = 0; i < circuit->num_ands; ++i) {
+    const aiger_and *a = circuit->ands + i;
+    if (!in_cone[aiger_lit2var(a->lhs)]) continue;
+    const std::uint64_t s = child(a->rhs0), t = child(a->rhs1);
+    hash[aiger_lit2var(a->lhs)] = mix(std::min(s, t) + mix(std::max(s, t)));
+  }
+
+  // Inputs are described by NONE, ands by their two renumbered inputs
+  std::vector<unsigned> id(n, NONE), words;
+  id[0] = 0;
+  unsigned next_id{1};
+  auto renumbered = [&id](unsigned l) {
+    return 2 * id[aiger_lit2var(l)] + aiger_sign(l);
+  };
+  std::vector<unsigned> stack{aiger_lit2var(lit)};
+  while (!stack.empty()) {
+    const unsigned u = stack.back();
+    if (id[u] != NONE) {
+      stack.pop_back();
+      continue;
+    }
+    if (gate[u] == NONE) {
+      stack.pop_back();
+      id[u] = next_id++;
+      words.push_back(NONE);
+      continue;
+    }
+    const aiger_and *a = circuit->ands + gate[u];
+    const bool swap = child(a->rhs1) < child(a->rhs0);
+    const unsigned first = swap ? a->rhs1 : a->rhs0;
+    const unsigned second = swap ? a->rhs0 : a->rhs1;
+    if (id[aiger_lit2var(second)] == NONE)
+      stack.push_back(aiger_lit2var(second));
+    if (id[aiger_lit2var(first)] == NONE) stack.push_back(aiger_lit2var(first));
+    if (stack.back() != u) continue;
+    stack.pop_back();
+    id[u] = next_id++;
+    words.push_back(renumbered(first));
+    words.push_back(renumbered(second));
+  }
+  words.push_back(renumbered(lit));
+  return {reinterpret_cast<const char *>(words.data()),
+          words.size() * sizeof(unsigned)};
+}
+
+bool cache_lookup(const char *dir, const std::string &cone) {
+  const fs::path path = entry(dir, cone);
+  std::error_code ec;
+  if (fs::file_size(path, ec) != cone.size() || ec) return false;
+  std::ifstream file(path, std::ios::binary);
+  const std::string stored{std::istreambuf_iterator<char>(file), {}};
+  if (stored != cone) return false;
+  fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+  return true;
+}
+
+void cache_store(const char *dir, const std::string &cone,
+                 std::uintmax_t limit) {
+  std::error_code ec;
+  fs::create_directories(dir, ec);
+  const fs::path path = entry(dir, cone);
+  fs::path temporary = path;
+  temporary += "." + std::to_string(getpid()) + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary);
+    file.write(cone.data(), static_cast<std::streamsize>(cone.size()));
+    if (!file) ec = std::make_error_code(std::errc::io_error);
+  }
+  if (!ec) fs::rename(temporary, path, ec);
+  if (ec) {
+    std::cerr << "Warning: could not write cache entry " << path << ": "
+              << ec.message() << "\n";
+    fs::remove(temporary, ec);
+    return;
+  }
+
+  std::vector<std::pair<fs::file_time_type, fs::path>> entries;
+  std::uintmax_t total{};
+  for (const auto &e : fs::directory_iterator(dir, ec)) {
+    if (e.path().extension() != ".cone") continue;
+    std::error_code gone; // entries may be evicted by another process
+    const auto size = e.file_size(gone);
+    const auto time = e.last_write_time(gone);
+    if (gone) continue;
+    total += size;
+    entries.emplace_back(time, e.path());
+  }
+  std::sort(entries.begin(), entries.end());
+  for (const auto &[time, old] : entries) {
+    if (total <= limit) break;
+    const auto size = fs::file_size(old, ec);
+    if (!ec && fs::remove(old, ec)) total -= size;
+  }
+}
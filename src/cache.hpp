@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "aiger.h"
+
+// Canonical description of the cone of influence of `lit` in a combinatorial
+// circuit whose ands are in topological order. Inputs and ands are renumbered
+// in the order of a depth-first search that visits the input of an and with
+// the smaller structural hash first, so the description does not depend on
+// how the circuit was numbered. Cones with equal descriptions are equal up to
+// renaming their inputs, and thus equisatisfiable.
+std::string describe_cone(const aiger *circuit, unsigned lit);
+
+// On-disk cache of cones proven unsatisfiable in the directory `dir`. Each
+// entry is a file named after the hash of a description that holds the full
+// description, so hits are only reported for identical cones. A hit refreshes
+// the modification time of the entry.
+bool cache_lookup(const char *dir, const std::string &cone);
+
+// Adds an unsatisfiable cone to the cache. The entry is written to a temporary
+// file and renamed, so concurrent processes never read partial entries.
+// Afterwards the least recently used entries are removed until the cache
+// takes at most `limit` bytes.
+void cache_store(const char *dir, const std::string &cone,
+                 std::uintmax_t limit);
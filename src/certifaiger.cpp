@@ -1,61 +1,277 @@
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <cassert>
 #include <cctype>
+#include <cerrno>
 #include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <iomanip>
 #include <iostream>
 #include <limits>
 #include <optional>
+#include <random>
+#include <sstream>
+#include <string>
 #include <string_view>
 #include <system_error>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include "aiger.h"
+#include "cache.hpp"
+#include "circuit.hpp"
+#include "cnf.hpp"
+#include "lrat.hpp"
+#include "simulate.hpp"
+#include "solve.hpp"
+#include "stats.hpp"
+#include "sweep.hpp"
+#include "write.hpp"
+#include "trace.hpp"
 namespace {
 
 constexpr unsigned INVALID_LIT = std::numeric_limits<unsigned>::max();
+constexpr unsigned LOCAL = 1u << 31; // tags literals local to an arena
 constexpr unsigned circuits{2}; // W, M
 constexpr unsigned times{3};    // t0, t1, t2
-aiger *model, *witness, *check;
-std::array<aiger *, circuits> aig;
+aiger *check;
+circuit *model, *witness;
+std::array<circuit *, circuits> aig;
 unsigned next_lit{2};
 struct predicates {
   unsigned R{1}, RK{1}, F{1}, FK{1}, C{1}, P{1};
+  std::vector<unsigned> FKs, Cs; // conjuncts of FK and C
 };
 
-bool reencoded(const aiger *circuit) {
+bool liveness(const circuit *c) {
+  return !c->justice.empty() || !c->fairness.empty();
+}
+
+bool reencoded(const circuit *c) {
   unsigned l{};
-  for (unsigned i = 0; i < circuit->num_inputs; ++i)
-    if (circuit->inputs[i].lit != 2 * (++l)) return false;
-  for (unsigned i = 0; i < circuit->num_latches; ++i)
-    if (circuit->latches[i].lit != 2 * (++l)) return false;
+  for (unsigned lit : c->inputs)
+    if (lit != 2 * (++l)) return false;
+  for (const latch &lat : c->latches)
+    if (lat.lit != 2 * (++l)) return false;
   return true;
 }
 
+// Families of obligations
+enum : unsigned { SIMULATION = 1, INDUCTIVE = 2, RANKED = 4 };
+
+struct options {
+  bool split{}; // write each obligation's cone to its own file
+  bool cnf{};   // write each obligation's cone to its own DIMACS file
+  bool pg{};    // polarity aware (Plaisted-Greenbaum) CNF encoding
+  unsigned solve{}; // threads checking obligations with the embedded solver
+  bool incremental{}; // solve all obligations in one incremental solver
+  bool proofs{};      // check the LRAT proofs of the embedded solver
+  unsigned obligations{SIMULATION | INDUCTIVE | RANKED};
+  unsigned simulate{}; // random patterns simulated before writing or solving
+  bool trace{};        // check counterexample traces instead of a witness
+  bool stats{};         // print time and memory per phase
+  const char *json{};   // write the statistics as JSON to this file instead
+  unsigned memory{};    // peak resident memory budget in megabytes
+  unsigned threads{1};  // threads encoding frames, the output is the same
+  const char *cache{};  // directory of obligations proven unsat before
+  unsigned cache_size{1024}; // megabytes
+  bool batch{};              // certify the pairs listed in a manifest
+  const char *manifest{};    // read from stdin if not given
+  unsigned workers{1};       // processes certifying pairs at once
+  unsigned partition{1}; // sub-obligations per wide conjunctive obligation
+  unsigned sweep{};      // conflict limit per equivalence, 0 if not sweeping
+  bool properties{};     // certify one property per witness of the model
+  bool lrat{};           // check a binary LRAT proof of a DIMACS formula
+} opt;
+std::vector<const char *> traces, witnesses;
+const char *formula_path{}, *proof_path{}; // of --check-lrat
+
+// Names of the certified properties, a single empty name unless certifying
+// with --properties, and the property of each obligation by output index.
+std::vector<std::string> certified{""};
+std::vector<unsigned> obligation_property;
+
+// Parses the value of an option of the form --name=value
+unsigned option_value(std::string_view arg, unsigned min = 0) {
+  const std::string_view value = arg.substr(arg.find('=') + 1);
+  const char *end = value.data() + value.size();
+  unsigned parsed{};
+  const auto [ptr, err] = std::from_chars(value.data(), end, parsed);
+  if (err != std::errc() || ptr != end || parsed < min)
+    std::cerr << "Invalid option '" << arg << "'\n", exit(1);
+  return parsed;
+}
+
+// Parses a comma separated list of obligation families
+unsigned families(std::string_view arg) {
+  unsigned selected{};
+  std::string_view list = arg.substr(arg.find('=') + 1);
+  while (!list.empty()) {
+    const auto comma = std::min(list.find(','), list.size());
+    const std::string_view family = list.substr(0, comma);
+    if (family == "simulation") selected |= SIMULATION;
+    else if (family == "inductive") selected |= INDUCTIVE;
+    else if (family == "ranked") selected |= RANKED;
+    else std::cerr << "Invalid obligation family '" << family << "'\n", exit(1);
+    list.remove_prefix(std::min(comma + 1, list.size()));
+  }
+  if (!selected) std::cerr << "Invalid option '" << arg << "'\n", exit(1);
+  return selected;
+}
+
+// Reads a model or witness and checks that its inputs and latches are
+// reencoded. Returns an error message, empty on success.
+std::string load(circuit *c, const char *path, const char *role) {
+  if (const char *err = read_circuit(c, path))
+    return std::string{"Error reading "} + role + " '" + path + "': " + err;
+  if (!reencoded(c))
+    return std::string{"Error: "} + role + " '" + path + "' is not reencoded";
+  return {};
+}
+
 // Parse command-line arguments, initialize aigs
 const char *initialize(int argc, char *argv[]) {
-  if (argc > 1 && !std::strcmp(argv[1], "--version"))
-    std::cout << VERSION << "\n", exit(0);
-  if (argc < 3)
-    std::cerr << "Usage: " << argv[0] << " model witness [check=check.aig]\n",
+  std::vector<const char *> positional;
+  const char *check_path{"check.aig"}; // with --properties
+  unsigned solve_threads{};            // given by --solve=threads
+  opt.threads = opt.workers = std::max(1u, std::thread::hardware_concurrency());
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    if (arg == "--version") std::cout << VERSION << "\n", exit(0);
+    if (arg == "--split") opt.split = true;
+    else if (arg == "--cnf") opt.cnf = true;
+    else if (arg == "--pg") opt.pg = true;
+    else if (arg == "--solve")
+      opt.solve = std::max(1u, std::thread::hardware_concurrency());
+    else if (arg.starts_with("--solve="))
+      opt.solve = solve_threads = option_value(arg, 1);
+    else if (arg == "--incremental") opt.incremental = true;
+    else if (arg == "--check-proofs") opt.proofs = true;
+    else if (arg.starts_with("--obligations=")) opt.obligations = families(arg);
+    else if (arg.starts_with("--simulate=")) opt.simulate = option_value(arg);
+    else if (arg == "--trace") opt.trace = true;
+    else if (arg == "--stats") opt.stats = true;
+    else if (arg.starts_with("--stats="))
+      opt.stats = true, opt.json = argv[i] + 8;
+    else if (arg.starts_with("--memory=")) opt.memory = option_value(arg, 1);
+    else if (arg.starts_with("--threads=")) opt.threads = option_value(arg, 1);
+    else if (arg.starts_with("--cache=")) opt.cache = argv[i] + 8;
+    else if (arg.starts_with("--cache-size="))
+      opt.cache_size = option_value(arg, 1);
+    else if (arg == "--batch") opt.batch = true;
+    else if (arg.starts_with("--batch="))
+      opt.batch = true, opt.manifest = argv[i] + 8;
+    else if (arg.starts_with("--workers=")) opt.workers = option_value(arg, 1);
+    else if (arg.starts_with("--partition="))
+      opt.partition = option_value(arg, 1);
+    else if (arg == "--sweep") opt.sweep = 1000;
+    else if (arg.starts_with("--sweep=")) opt.sweep = option_value(arg, 1);
+    else if (arg == "--properties") opt.properties = true;
+    else if (arg.starts_with("--properties="))
+      opt.properties = true, check_path = argv[i] + 13;
+    else if (arg == "--check-lrat") opt.lrat = true;
+    else if (arg.starts_with("--"))
+      std::cerr << "Unknown option '" << arg << "'\n", exit(1);
+    else positional.push_back(argv[i]);
+  }
+  if (opt.incremental && solve_threads > 1)
+    std::cerr << "Error: --incremental solves on a single thread, can not be "
+                 "combined with --solve=" << solve_threads << "\n",
+        exit(1);
+  if (opt.incremental) opt.solve = 1;
+  if (opt.memory) stats_budget(opt.memory);
+  if (opt.solve && !embedded_solver())
+    std::cerr << "Error: built without embedded SAT solver for --solve\n",
         exit(1);
+  if (opt.cache && !opt.solve)
+    std::cerr << "Error: --cache requires --solve\n", exit(1);
+  if (opt.incremental && !embedded_incremental())
+    std::cerr << "Error: embedded SAT solver " << embedded_solver()
+              << " is not incremental\n",
+        exit(1);
+  if (opt.proofs && (!opt.solve || opt.incremental))
+    std::cerr << "Error: --check-proofs requires --solve without "
+                 "--incremental\n",
+        exit(1);
+  if (opt.proofs && !embedded_lrat())
+    std::cerr << "Error: embedded SAT solver " << embedded_solver()
+              << " does not produce LRAT proofs for --check-proofs\n",
+        exit(1);
+  if (opt.sweep && !embedded_incremental())
+    std::cerr << "Error: --sweep requires an incremental embedded SAT "
+                 "solver\n",
+        exit(1);
+  if (opt.sweep && opt.proofs)
+    std::cerr << "Error: --sweep merges nodes on unchecked solver answers, "
+                 "can not be combined with --check-proofs\n",
+        exit(1);
+  if (opt.batch && opt.trace)
+    std::cerr << "Error: --batch can not check traces\n", exit(1);
+  if (opt.properties && (opt.batch || opt.trace))
+    std::cerr << "Error: --properties can not be combined with --batch or "
+                 "--trace\n",
+        exit(1);
+  if (opt.batch) return nullptr;
+  if (positional.size() < 2)
+    std::cerr << "Usage: " << argv[0]
+              << " [--split] [--cnf] [--pg] [--solve[=threads]] "
+                 "[--incremental] [--check-proofs] "
+                 "[--obligations=simulation,inductive,ranked] "
+                 "[--simulate=patterns] [--stats[=file]] [--memory=MB] "
+                 "[--threads=N] [--cache=dir] [--cache-size=MB] "
+                 "[--partition=k] [--sweep[=conflicts]] "
+                 "model witness [check=check.aig]\n"
+                 "       "
+              << argv[0] << " --trace [--stats[=file]] model trace...\n"
+              << "       " << argv[0]
+              << " --batch[=manifest] [--workers=N] [options]\n"
+              << "       " << argv[0]
+              << " --properties[=check] [options] model witness...\n"
+              << "       " << argv[0] << " --check-lrat formula proof\n",
+        exit(1);
+  if (opt.lrat) {
+    formula_path = positional[0], proof_path = positional[1];
+    return nullptr;
+  }
+  if (opt.trace) {
+    model = new circuit;
+    if (const char *err = read_circuit(model, positional[0]))
+      std::cerr << "Error reading model '" << positional[0] << "': " << err
+                << '\n',
+          exit(1);
+    traces.assign(positional.begin() + 1, positional.end());
+    return nullptr;
+  }
+  if (opt.properties) {
+    model = new circuit;
+    const std::string err = load(model, positional[0], "model");
+    if (!err.empty()) std::cerr << err << '\n', exit(1);
+    witnesses.assign(positional.begin() + 1, positional.end());
+    std::cout << "Certify Model Checking Witnesses in AIGER\n";
+    std::cout << VERSION << " " << GITID << "\n";
+    return check_path;
+  }
   // for the rest of the logic witness comes before model
-  const char *paths[3] = {argv[2], argv[1], argc > 3 ? argv[3] : "check.aig"};
-  check = aiger_init();
-  aig = {witness = aiger_init(), model = aiger_init()};
+  const char *paths[3] = {positional[1], positional[0],
+                          positional.size() > 2 ? positional[2] : "check.aig"};
+  aig = {witness = new circuit, model = new circuit};
   for (unsigned c = 0; c < circuits; ++c) {
-    if (const char *err = aiger_open_and_read_from_file(aig[c], paths[c]))
-      std::cerr << "Error reading " << (c ? "model '" : "witness '") << paths[c]
-                << "': " << err << '\n',
-          exit(1);
-
-    if (!reencoded(aig[c]))
-      std::cerr << "Error: " << (c ? "model '" : "witness '") << paths[c]
-                << "' is not reencoded\n",
-          exit(1);
+    const std::string err = load(aig[c], paths[c], c ? "model" : "witness");
+    if (!err.empty()) std::cerr << err << '\n', exit(1);
   }
   std::cout << "Certify Model Checking Witnesses in AIGER\n";
   std::cout << VERSION << " " << GITID << "\n";
@@ -63,31 +279,200 @@ const char *initialize(int argc, char *argv[]) {
   return paths[2];
 }
 
-void finalize(const char *path) {
-  if (!aiger_open_and_write_to_file(check, path))
-    std::cerr << "Error writing " << path << "\n", exit(1);
+// Marks the transitive fan-in of `lit` in the check circuit. The ands are
+// added in topological order, so a single backward sweep suffices.
+std::vector<bool> cone(unsigned lit) {
+  std::vector<bool> in_cone(check->maxvar + 1);
+  in_cone[aiger_lit2var(lit)] = true;
+  for (unsigned i = check->num_ands; i-- > 0;) {
+    const aiger_and *a = check->ands + i;
+    if (!in_cone[aiger_lit2var(a->lhs)]) continue;
+    in_cone[aiger_lit2var(a->rhs0)] = true;
+    in_cone[aiger_lit2var(a->rhs1)] = true;
+  }
+  return in_cone;
+}
+
+// Path of the file for a single obligation, named after the check path with
+// the obligation appended, e.g. check_Reset.aig or check_Reset.aig.gz.
+std::string obligation_path(std::string_view path, std::string_view name,
+                            std::string_view extension = {}) {
+  auto dot = path.rfind('.');
+  if (dot != path.npos && dot && path.substr(dot) == ".gz")
+    dot = path.rfind('.', dot - 1);
+  const bool has_extension =
+      dot != std::string_view::npos && path.find('/', dot) == path.npos;
+  if (extension.empty()) extension = has_extension ? path.substr(dot) : ".aig";
+  std::string file{has_extension ? path.substr(0, dot) : path};
+  file.append("_").append(name).append(extension);
+  return file;
+}
+
+// Number of inputs and ands in a cone of influence.
+unsigned cone_inputs(const std::vector<bool> &in_cone) {
+  unsigned inputs{};
+  for (unsigned i = 0; i < check->num_inputs; ++i)
+    inputs += in_cone[aiger_lit2var(check->inputs[i].lit)];
+  return inputs;
+}
+unsigned cone_ands(const std::vector<bool> &in_cone) {
+  unsigned ands{};
+  for (unsigned i = 0; i < check->num_ands; ++i)
+    ands += in_cone[aiger_lit2var(check->ands[i].lhs)];
+  return ands;
+}
+
+// Streams the cone of influence of each obligation to its own file.
+void write_cones(std::string_view path) {
+  for (unsigned o = 0; o < check->num_outputs; ++o) {
+    const aiger_symbol *output = check->outputs + o;
+    const auto in_cone = cone(output->lit);
+    std::cout << "Cone " << output->name << ": " << cone_inputs(in_cone)
+              << " inputs " << cone_ands(in_cone) << " ands\n";
+    const auto file = obligation_path(path, output->name);
+    if (!write_aiger(check, file.c_str(), {o}, &in_cone))
+      std::cerr << "Error writing " << file << "\n", exit(1);
+  }
+}
+
+// Tseitin encodes each obligation directly to its own DIMACS file.
+void write_cnfs(std::string_view path) {
+  for (unsigned o = 0; o < check->num_outputs; ++o) {
+    const aiger_symbol *output = check->outputs + o;
+    const cnf formula = encode(check, output->lit, opt.pg);
+    std::cout << "CNF " << output->name << ": " << formula.variables
+              << " variables " << formula.clauses << " clauses\n";
+    const auto file = obligation_path(path, output->name, ".cnf");
+    if (!write_dimacs(formula, file.c_str()))
+      std::cerr << "Error writing " << file << "\n", exit(1);
+  }
+}
+
+// Records the cone size and depth of each obligation for the statistics.
+void cone_stats() {
+  std::vector<unsigned> depth(check->maxvar + 1);
+  for (unsigned i = 0; i < check->num_ands; ++i) {
+    const aiger_and *a = check->ands + i;
+    depth[aiger_lit2var(a->lhs)] = 1 + std::max(depth[aiger_lit2var(a->rhs0)],
+                                                depth[aiger_lit2var(a->rhs1)]);
+  }
+  for (unsigned o = 0; o < check->num_outputs; ++o) {
+    const aiger_symbol *output = check->outputs + o;
+    const auto in_cone = cone(output->lit);
+    stats_cone(output->name, cone_inputs(in_cone), cone_ands(in_cone),
+               depth[aiger_lit2var(output->lit)]);
+  }
+}
+
+// Checks the obligations with the embedded solver, skipping those found in
+// the cache. If all obligations of a property are unsat, the solved ones are
+// added to the cache. With --properties, each property is checked to the end
+// and its result reported.
+bool solve_obligations() {
+  std::vector<obligation> obligations;
+  std::vector<std::pair<std::string, unsigned>> cones; // and their property
+  obligations.reserve(check->num_outputs);
+  for (unsigned o = 0; o < check->num_outputs; ++o) {
+    const aiger_symbol *output = check->outputs + o;
+    const unsigned property = obligation_property[o];
+    if (opt.cache) {
+      std::string description = describe_cone(check, output->lit);
+      if (cache_lookup(opt.cache, description)) {
+        std::cout << output->name << ": unsat (cached)\n";
+        stats_solved(output->name, 0, true);
+        continue;
+      }
+      cones.emplace_back(std::move(description), property);
+    }
+    obligations.push_back(
+        {output->name, output->lit, cone_ands(cone(output->lit)), property});
+  }
+  std::vector<bool> refuted(certified.size());
+  auto *per_property = opt.properties ? &refuted : nullptr;
+  const bool passed =
+      obligations.empty() ||
+      (opt.incremental
+           ? solve_incremental(check, obligations, opt.pg, per_property)
+           : solve(check, obligations, opt.solve, opt.pg, opt.proofs,
+                   per_property));
+  if (!passed && !opt.properties) refuted[0] = true;
+  for (const auto &[description, property] : cones)
+    if (!refuted[property])
+      cache_store(opt.cache, description,
+                  std::uintmax_t{opt.cache_size} << 20);
+  if (opt.properties)
+    for (std::size_t p = 0; p < certified.size(); ++p)
+      std::cout << "Property " << certified[p]
+                << (refuted[p] ? " failed\n" : " passed\n");
+  return passed;
+}
+
+// Replaces the check circuit by its swept copy and reports the ands removed
+// from the cone of each obligation.
+void sweep_check() {
+  stats_phase("sweep", check->num_ands);
+  std::vector<unsigned> before;
+  before.reserve(check->num_outputs);
+  for (unsigned o = 0; o < check->num_outputs; ++o)
+    before.push_back(cone_ands(cone(check->outputs[o].lit)));
+  aiger *swept = sweep(check, opt.sweep);
   aiger_reset(check);
-  aiger_reset(witness);
-  aiger_reset(model);
+  check = swept;
+  for (unsigned o = 0; o < check->num_outputs; ++o) {
+    const aiger_symbol *output = check->outputs + o;
+    const long removed = static_cast<long>(before[o]) -
+                         static_cast<long>(cone_ands(cone(output->lit)));
+    std::cout << "Sweep " << output->name << ": " << before[o] << " ands, "
+              << removed << " removed\n";
+  }
+}
+
+// Reports the statistics and frees the circuits, returns the exit code.
+int conclude(bool passed) {
+  if (opt.stats) print_stats(opt.json, check->num_ands);
+  aiger_reset(check);
+  delete witness;
+  delete model;
+  return passed ? 0 : 1;
+}
+
+// Writes the check and solves the obligations, returns the exit code.
+int finalize(const char *path) {
+  if (opt.sweep) sweep_check();
+  stats_phase("finalize", check->num_ands);
+  std::cout << "Check circuit: " << check->num_inputs << " inputs "
+            << check->num_ands << " ands\n";
+  if (opt.stats) cone_stats();
+  if (opt.split) write_cones(path);
+  if (opt.cnf) write_cnfs(path);
+  if (!opt.split && !opt.cnf && !opt.solve) {
+    std::vector<unsigned> outputs(check->num_outputs);
+    for (unsigned o = 0; o < check->num_outputs; ++o) outputs[o] = o;
+    if (!write_aiger(check, path, outputs))
+      std::cerr << "Error writing " << path << "\n", exit(1);
+  }
+  if (opt.solve) stats_phase("solve", check->num_ands);
+  const bool passed = !opt.solve || solve_obligations();
+  if (opt.solve)
+    std::cout << "Certificate check " << (passed ? "passed" : "failed") << "\n";
+  return conclude(passed);
 }
 
 // Checks if the circuit is stratified (no cyclic dependencies in the reset
 // definition) using Kahn. In addition to ands, latches have an edge to their
-// reset.
-bool stratified(const aiger *circuit) {
-  const unsigned n = circuit->maxvar + 1;
+// reset. If requested, `order` lists the variables such that each comes
+// after its dependencies.
+bool stratified(const circuit *c, std::vector<unsigned> *order = nullptr) {
+  const unsigned n = c->maxvar + 1;
   std::vector<unsigned> in_degree(n);
   std::vector<unsigned> stack;
   stack.reserve(n);
-  for (unsigned i = 0; i < circuit->num_ands; ++i) {
-    aiger_and *a = circuit->ands + i;
-    in_degree[aiger_lit2var(a->rhs0)]++;
-    in_degree[aiger_lit2var(a->rhs1)]++;
-  }
-  for (unsigned i = 0; i < circuit->num_latches; ++i) {
-    aiger_symbol *l = circuit->latches + i;
-    if (l->reset != l->lit) in_degree[aiger_lit2var(l->reset)]++;
+  for (const aiger_and &a : c->ands) {
+    in_degree[aiger_lit2var(a.rhs0)]++;
+    in_degree[aiger_lit2var(a.rhs1)]++;
   }
+  for (const latch &l : c->latches)
+    if (l.reset != l.lit) in_degree[aiger_lit2var(l.reset)]++;
   for (unsigned i = 0; i < n; ++i)
     if (!in_degree[i]) stack.push_back(i);
   unsigned visited{};
@@ -95,25 +480,39 @@ bool stratified(const aiger *circuit) {
     unsigned l{aiger_var2lit(stack.back())};
     stack.pop_back();
     visited++;
-    if (aiger_and *a = aiger_is_and(circuit, l)) {
+    if (order) order->push_back(aiger_lit2var(l));
+    if (const aiger_and *a = is_and(c, l)) {
       unsigned s = aiger_lit2var(a->rhs0);
       unsigned t = aiger_lit2var(a->rhs1);
       if (!--in_degree[s]) stack.push_back(s);
       if (!--in_degree[t]) stack.push_back(t);
-    } else if (aiger_symbol *lat = aiger_is_latch(circuit, l)) {
+    } else if (const latch *lat = is_latch(c, l)) {
       unsigned r = aiger_lit2var(lat->reset);
       if (lat->reset != lat->lit && !--in_degree[r]) stack.push_back(r);
     }
   }
+  if (order) std::reverse(order->begin(), order->end());
   return visited == n;
 }
 
+// Structural hashing of the ands in the check circuit, keyed by the
+// normalized pair of inputs.
+std::unordered_map<std::uint64_t, unsigned> strash;
+
 unsigned conj(unsigned s, unsigned t) {
+  if (s < t) std::swap(s, t);
+  if (!t || s == aiger_not(t)) return 0;
+  if (t == 1 || s == t) return s;
+  const auto [it, added] =
+      strash.try_emplace(std::uint64_t{s} << 32 | t, next_lit);
+  if (!added) return it->second;
   assert(next_lit % 2 == 0);
+  if (next_lit >= LOCAL)
+    std::cerr << "Error: check circuit too large\n", exit(1);
   aiger_add_and(check, next_lit, s, t);
-  unsigned ret{next_lit};
   next_lit += 2;
-  return ret;
+  if (!(check->num_ands & 0xffff)) stats_reserve(0);
+  return it->second;
 }
 template <typename... Rest>
 unsigned conj(unsigned s, unsigned t, unsigned u, Rest... rest) {
@@ -123,6 +522,23 @@ template <typename... Rest>
 unsigned disj(unsigned s, unsigned t, Rest... rest) {
   return aiger_not(conj(aiger_not(s), aiger_not(t), aiger_not(rest)...));
 }
+// Conjunction of `lits` as a balanced tree of ands, so its depth grows
+// logarithmically instead of linearly with the number of lits.
+unsigned conj_tree(std::vector<unsigned> lits) {
+  if (lits.empty()) return 1;
+  while (lits.size() > 1) {
+    std::size_t reduced{};
+    for (std::size_t i = 0; i + 1 < lits.size(); i += 2)
+      lits[reduced++] = conj(lits[i], lits[i + 1]);
+    if (lits.size() % 2) lits[reduced++] = lits.back();
+    lits.resize(reduced);
+  }
+  return lits[0];
+}
+unsigned disj_tree(std::vector<unsigned> lits) {
+  for (unsigned &l : lits) l = aiger_not(l);
+  return aiger_not(conj_tree(std::move(lits)));
+}
 unsigned imply(unsigned s, unsigned t) {
   return aiger_not(conj(s, aiger_not(t)));
 }
@@ -130,6 +546,171 @@ unsigned equivalent(unsigned s, unsigned t) {
   return conj(imply(s, t), imply(t, s));
 }
 
+// Literals of the check circuit for the variables of a circuit in one time
+// frame, or intervened between two. Only the cones that are requested through
+// `literal` are encoded. Inputs and latches become fresh inputs of the check
+// circuit, or are taken from `base` in an intervened frame.
+struct frame {
+  const circuit *c{};
+  std::vector<unsigned> var; // INVALID_LIT if not encoded yet
+  frame *base{};
+};
+
+frame make_frame(const circuit *c, frame *base = nullptr) {
+  frame f{c, std::vector<unsigned>(c->maxvar + 1, INVALID_LIT), base};
+  f.var[0] = 0;
+  return f;
+}
+
+// Maps `lit` of the circuit to `to` in the check circuit.
+void assign(frame &f, unsigned lit, unsigned to) {
+  f.var[aiger_lit2var(lit)] = to ^ aiger_sign(lit);
+}
+
+unsigned input() {
+  assert(next_lit % 2 == 0);
+  if (next_lit >= LOCAL)
+    std::cerr << "Error: check circuit too large\n", exit(1);
+  aiger_add_input(check, next_lit, nullptr);
+  next_lit += 2;
+  return next_lit - 2;
+}
+
+// Encodes the cone of `lit` in `f`, combining the inputs of ands with `gate`
+// and mapping variables that are no ands with `leaf`.
+template <typename Gate, typename Leaf>
+unsigned encode(frame &f, unsigned lit, Gate gate, Leaf leaf) {
+  const unsigned v = aiger_lit2var(lit);
+  if (f.var[v] != INVALID_LIT) return f.var[v] ^ aiger_sign(lit);
+  std::vector<unsigned> stack{v};
+  while (!stack.empty()) {
+    const unsigned u = stack.back();
+    if (f.var[u] != INVALID_LIT) {
+      stack.pop_back();
+      continue;
+    }
+    const aiger_and *a = is_and(f.c, aiger_var2lit(u));
+    if (!a) {
+      stack.pop_back();
+      f.var[u] = leaf(u);
+      continue;
+    }
+    const unsigned s = aiger_lit2var(a->rhs0), t = aiger_lit2var(a->rhs1);
+    if (f.var[s] == INVALID_LIT) stack.push_back(s);
+    if (f.var[t] == INVALID_LIT) stack.push_back(t);
+    if (stack.back() != u) continue;
+    stack.pop_back();
+    f.var[u] = gate(f.var[s] ^ aiger_sign(a->rhs0),
+                    f.var[t] ^ aiger_sign(a->rhs1));
+  }
+  return f.var[v] ^ aiger_sign(lit);
+}
+
+// Literal of the check circuit for `lit`, encoding its cone if needed.
+unsigned literal(frame &f, unsigned lit) {
+  return encode(
+      f, lit, [](unsigned s, unsigned t) { return conj(s, t); },
+      [&f](unsigned v) {
+        return f.base ? literal(*f.base, aiger_var2lit(v)) : input();
+      });
+}
+
+// Literal of the check circuit for `lit` if its cone was encoded.
+std::optional<unsigned> encoded(const frame &f, unsigned lit) {
+  const unsigned v = f.var[aiger_lit2var(lit)];
+  if (v == INVALID_LIT) return std::nullopt;
+  return v ^ aiger_sign(lit);
+}
+
+// Cones of frames encoded by a worker thread. The nodes are ands, or fresh
+// inputs if both inputs are INVALID_LIT. Literals tagged with LOCAL refer to
+// the nodes, 2 * index plus sign, all others to the check circuit. The check
+// circuit is only read while the arenas are filled, and its ands are reused.
+struct arena {
+  std::vector<std::pair<unsigned, unsigned>> nodes;
+  std::unordered_map<std::uint64_t, unsigned> strash;
+};
+
+unsigned node(arena &a, unsigned s, unsigned t) {
+  if (a.nodes.size() >= LOCAL / 2 - 1)
+    std::cerr << "Error: check circuit too large\n", exit(1);
+  a.nodes.emplace_back(s, t);
+  return LOCAL | static_cast<unsigned>(2 * (a.nodes.size() - 1));
+}
+
+unsigned conj(arena &a, unsigned s, unsigned t) {
+  if (s < t) std::swap(s, t);
+  if (!t || s == aiger_not(t)) return 0;
+  if (t == 1 || s == t) return s;
+  const std::uint64_t key{std::uint64_t{s} << 32 | t};
+  if (!(s & LOCAL))
+    if (const auto it = strash.find(key); it != strash.end()) return it->second;
+  if (const auto it = a.strash.find(key); it != a.strash.end())
+    return it->second;
+  return a.strash.emplace(key, node(a, s, t)).first->second;
+}
+
+// Literal of `lit` in the arena, encoding its cone if needed. Without an
+// arena the cone is encoded directly into the check circuit. The base frame
+// is shared by concurrent jobs, so its leaves have to be encoded before.
+unsigned literal(arena *a, frame &f, unsigned lit) {
+  if (!a) return literal(f, lit);
+  return encode(
+      f, lit, [a](unsigned s, unsigned t) { return conj(*a, s, t); },
+      [a, &f](unsigned v) {
+        if (!f.base) return node(*a, INVALID_LIT, INVALID_LIT);
+        assert(f.base->var[v] != INVALID_LIT);
+        return f.base->var[v];
+      });
+}
+
+// Adds the nodes of the arena to the check circuit in order and replaces the
+// local literals of its frames.
+void merge(const arena &a, const std::vector<frame *> &frames) {
+  std::vector<unsigned> lits(a.nodes.size());
+  strash.reserve(strash.size() + a.nodes.size());
+  auto resolve = [&lits](unsigned l) {
+    if (l == INVALID_LIT || !(l & LOCAL)) return l;
+    return lits[(l & ~LOCAL) >> 1] ^ aiger_sign(l);
+  };
+  for (std::size_t i = 0; i < a.nodes.size(); ++i) {
+    const auto [s, t] = a.nodes[i];
+    lits[i] = s == INVALID_LIT ? input() : conj(resolve(s), resolve(t));
+  }
+  for (frame *f : frames)
+    for (unsigned &v : f->var) v = resolve(v);
+}
+
+// Frames encoded by one worker, see `encode_concurrently`.
+struct job {
+  std::vector<frame *> frames;
+  std::function<void(arena *)> encode;
+};
+
+// Runs the jobs on up to `opt.threads` threads, each into its own arena, and
+// merges the arenas in the order of the jobs. Merging replays the ands in the
+// order they were encoded, so the check circuit is the same as when running
+// the jobs one after the other directly on the check circuit, which is done
+// for a single thread.
+void encode_concurrently(const std::vector<job> &jobs) {
+  if (opt.threads == 1 || jobs.size() == 1) {
+    for (const job &j : jobs) j.encode(nullptr);
+    return;
+  }
+  std::vector<arena> arenas(jobs.size());
+  std::atomic<std::size_t> next{};
+  auto work = [&] {
+    for (std::size_t j; (j = next++) < jobs.size();) jobs[j].encode(&arenas[j]);
+  };
+  const auto threads = std::min<std::size_t>(opt.threads, jobs.size());
+  std::vector<std::thread> pool;
+  for (std::size_t t = 1; t < threads; ++t) pool.emplace_back(work);
+  work();
+  for (auto &thread : pool) thread.join();
+  for (std::size_t j = 0; j < jobs.size(); ++j)
+    merge(arenas[j], jobs[j].frames);
+}
+
 std::optional<std::pair<unsigned, std::string_view>>
 parse_num(std::string_view c, const char *msg) {
   const auto start = c.find_first_not_of(" \f\n\r\t\v");
@@ -145,15 +726,22 @@ parse_num(std::string_view c, const char *msg) {
   return std::pair{value, c.substr(offset)};
 }
 
+// Removes the first line from `text` and returns it.
+std::string_view next_line(std::string_view &text) {
+  const auto newline = std::min(text.find('\n'), text.size());
+  const std::string_view line = text.substr(0, newline);
+  text.remove_prefix(std::min(newline + 1, text.size()));
+  return line;
+}
+
 bool read_mapping_comment(std::vector<std::pair<unsigned, unsigned>> &mapping,
                           std::string_view keyword) {
   assert(mapping.empty());
-  if (!witness->comments) return false;
-  const char *const *p = witness->comments;
+  std::string_view comments = witness->comments;
   bool found{};
   unsigned num_mapped{};
-  for (const char *c; (c = *p++);) {
-    std::string_view line{c};
+  while (!comments.empty()) {
+    const std::string_view line = next_line(comments);
     if (!line.starts_with(keyword)) continue;
     found = true;
     auto parsed_num =
@@ -168,12 +756,12 @@ bool read_mapping_comment(std::vector<std::pair<unsigned, unsigned>> &mapping,
             << " literals\n";
   mapping.reserve(num_mapped);
   for (unsigned i = 0; i < num_mapped; ++i) {
-    const char *c = *p++;
-    if (!c) {
+    if (comments.empty()) {
       std::cerr << "Ignoring incomplete mapping" << num_mapped << " lines\n";
       return false;
     }
-    auto witness_lit = parse_num(c, "mapping due to witness literal");
+    auto witness_lit =
+        parse_num(next_line(comments), "mapping due to witness literal");
     if (!witness_lit) return false;
     auto model_lit =
         parse_num(witness_lit->second, "mapping due to model literal");
@@ -187,16 +775,9 @@ bool read_mapping_symbols(std::vector<std::pair<unsigned, unsigned>> &mapping,
                           const char symbol) {
   assert(mapping.empty());
   bool found{};
-  mapping.reserve(witness->num_inputs + witness->num_latches);
-  for (unsigned i = 0; i < witness->num_inputs + witness->num_latches; ++i) {
-    unsigned s = 2 * (i + 1);
-    bool mapped{};
-    const char *c = aiger_get_symbol(witness, s);
-    if (!c) continue;
-    std::string_view name{c};
+  for (auto [s, name] : witness->symbols) {
     const auto pos = name.find(symbol);
-    mapped = pos != std::string_view::npos;
-    if (!mapped) continue;
+    if (pos == std::string_view::npos) continue;
     auto literal = parse_num(name.substr(pos + 1), "mapping in symbol table");
     if (!literal) continue;
     found = true;
@@ -216,14 +797,14 @@ std::array<std::vector<std::pair<unsigned, unsigned>>, 2> read_mapping() {
   if (!read_mapping_comment(shared, "MAPPING ") &&
       !read_mapping_symbols(shared, '=')) {
     std::cout << "No shared literals mapping found, using default\n";
-    const unsigned mapped_inputs =
-        std::min(model->num_inputs, witness->num_inputs);
-    const unsigned mapped_latches =
-        std::min(model->num_latches, witness->num_latches);
+    const auto mapped_inputs =
+        std::min(model->inputs.size(), witness->inputs.size());
+    const auto mapped_latches =
+        std::min(model->latches.size(), witness->latches.size());
     shared.reserve(mapped_inputs + mapped_latches);
-    for (unsigned i = 0; i < mapped_inputs; ++i)
-      shared.emplace_back(witness->inputs[i].lit, model->inputs[i].lit);
-    for (unsigned i = 0; i < mapped_latches; ++i)
+    for (std::size_t i = 0; i < mapped_inputs; ++i)
+      shared.emplace_back(witness->inputs[i], model->inputs[i]);
+    for (std::size_t i = 0; i < mapped_latches; ++i)
       shared.emplace_back(witness->latches[i].lit, model->latches[i].lit);
   }
 
@@ -231,211 +812,322 @@ std::array<std::vector<std::pair<unsigned, unsigned>>, 2> read_mapping() {
   if (!read_mapping_comment(interventions, "INTERVENTION ") &&
       !read_mapping_symbols(interventions, '<')) {
     std::cout << "No intervention mapping found, using default\n";
-    interventions.reserve(model->num_latches);
-    for (unsigned i = 0; i < witness->num_latches; ++i) {
-      aiger_symbol *l = witness->latches + i;
-      if (aiger_is_constant(l->next)) continue;
-      interventions.emplace_back(l->lit, l->next);
+    interventions.reserve(witness->latches.size());
+    for (const latch &l : witness->latches) {
+      if (aiger_is_constant(l.next)) continue;
+      interventions.emplace_back(l.lit, l.next);
     }
   }
 
   return {shared, interventions};
 }
 
+// Signals whose negations form the safety property of `c`. If neither bad
+// nor justice is defined assume old aiger, where the outputs are bad.
+const std::vector<unsigned> &safety(const circuit *c) {
+  return c->bad.empty() && c->justice.empty() ? c->outputs : c->bad;
+}
+
+// Model properties certified by a witness: the signals whose negations form
+// the safety property P, and the fairness and justice signals forming Q.
+struct property {
+  std::string name; // empty if the witness certifies all properties
+  std::vector<unsigned> bad, fairness;
+  std::vector<std::vector<unsigned>> justice;
+};
+
+property all_properties() {
+  return {{}, safety(model), model->fairness, model->justice};
+}
+
+// The property named in the WITNESS comment of the witness, e.g. b3 for the
+// fourth bad signal or j0 for the first justice property of the model, with
+// o indexing the outputs of old AIGER files like b. All properties if there
+// is no such comment.
+property witnessed_property() {
+  std::string_view comments = witness->comments;
+  while (!comments.empty()) {
+    std::string_view line = next_line(comments);
+    if (!line.starts_with("WITNESS ")) continue;
+    const std::string_view name = line.substr(8, line.find(' ', 8) - 8);
+    if (name.empty()) break;
+    const char kind = name[0];
+    const char *end = name.data() + name.size();
+    unsigned index{};
+    const auto [ptr, err] = std::from_chars(name.data() + 1, end, index);
+    const bool justice = kind == 'j';
+    if ((kind != 'b' && kind != 'o' && !justice) || err != std::errc() ||
+        ptr != end ||
+        index >= (justice ? model->justice.size() : safety(model).size()))
+      std::cerr << "Error: witness certifies unknown property '" << name
+                << "'\n",
+          exit(1);
+    if (justice)
+      return {std::string{name}, {}, model->fairness, {model->justice[index]}};
+    return {std::string{name}, {safety(model)[index]}, {}, {}};
+  }
+  return all_properties();
+}
+
+// Literals whose cones the predicates need in a frame of `c`.
+std::vector<unsigned> roots(const circuit *c, bool transition, bool fair) {
+  std::vector<unsigned> lits(c->constraints);
+  for (const latch &l : c->latches) {
+    lits.push_back(l.lit), lits.push_back(l.reset);
+    if (transition) lits.push_back(l.next);
+  }
+  lits.insert(lits.end(), safety(c).begin(), safety(c).end());
+  if (fair) {
+    lits.insert(lits.end(), c->fairness.begin(), c->fairness.end());
+    for (const auto &justice : c->justice)
+      lits.insert(lits.end(), justice.begin(), justice.end());
+  }
+  return lits;
+}
+
+// True if the selected obligations refer to the model, which only those of
+// the simulation family do. Otherwise the model is not unrolled at all.
+bool model_needed() { return opt.obligations & SIMULATION; }
+
 // Create three copies of the merged witness and model circuits with latches
 // turned to inputs. The witness has the lower indices as it is often a
-// superset of the model.
+// superset of the model. Model gates that are structurally identical to
+// witness gates over the shared literals are merged by `conj`.
+// Only the first `frames` copies are materialized, and of those only the
+// cones of the predicates, plus those of the model Q lits at time 0 if
+// `fair`. The model frames are left empty unless `model_needed`. The time
+// frames are encoded concurrently.
 // Returns map[circuit][time]
-std::array<std::array<std::vector<unsigned>, times>, circuits>
-unroll(const std::vector<std::pair<unsigned, unsigned>> &shared) {
-  const std::array<unsigned, circuits> size = {2 * (witness->maxvar + 1),
-                                               2 * (model->maxvar + 1)};
-  std::array<std::array<std::vector<unsigned>, times>, circuits> map;
+std::array<std::array<frame, times>, circuits>
+unroll(const std::vector<std::pair<unsigned, unsigned>> &shared,
+       unsigned frames, bool fair) {
+  const bool with_model = model_needed();
+  stats_reserve(std::size_t{frames} * sizeof(unsigned) *
+                (witness->maxvar + 1 + (with_model ? model->maxvar + 1 : 0)));
+  std::array<std::array<frame, times>, circuits> map;
+  std::vector<job> jobs;
+  for (unsigned t = 0; t < frames; ++t) {
+    frame *w = &(map[0][t] = make_frame(witness));
+    frame *m = with_model ? &(map[1][t] = make_frame(model)) : nullptr;
+    const bool transition = t + 1 < frames, first = t == 0;
+    jobs.push_back({m ? std::vector{w, m} : std::vector{w},
+                    [&shared, w, m, transition, fair, first](arena *a) {
+                      for (unsigned l : roots(witness, transition, false))
+                        literal(a, *w, l);
+                      if (!m) return;
+                      // map the shared latches already in the witness
+                      for (auto [wl, ml] : shared)
+                        assign(*m, ml, literal(a, *w, wl));
+                      for (unsigned l : roots(model, transition, fair && first))
+                        literal(a, *m, l);
+                    }});
+  }
+  encode_concurrently(jobs);
+  return map;
+}
 
-  for (unsigned c = 0; c < circuits; ++c) {
-    for (unsigned t = 0; t < times; ++t) {
-      map[c][t].assign(size[c], INVALID_LIT);
-      map[c][t][0] = 0;
-      map[c][t][1] = 1;
-    }
+// True if the shared literals are inputs or latches in both circuits and
+// mapped one to one. Then the model can be unrolled on its own and the
+// witness frames take the shared literals from the model frames, which is
+// equivalent to taking the model literals from the witness as in `unroll`.
+bool shareable(const std::vector<std::pair<unsigned, unsigned>> &shared) {
+  auto leaf = [](const circuit *c, unsigned lit) {
+    return aiger_lit2var(lit) <= c->maxvar &&
+           (is_input(c, lit) || is_latch(c, lit));
+  };
+  std::vector<bool> w(witness->maxvar + 1), m(model->maxvar + 1);
+  for (auto [wl, ml] : shared) {
+    if (!leaf(witness, wl) || !leaf(model, ml)) return false;
+    if (w[aiger_lit2var(wl)] || m[aiger_lit2var(ml)]) return false;
+    w[aiger_lit2var(wl)] = m[aiger_lit2var(ml)] = true;
   }
+  return true;
+}
 
+// Three copies of the model alone with latches turned to inputs, shared by
+// the witnesses of all properties. The cones of the predicates are encoded
+// concurrently in the first `frames` copies, others are encoded on demand.
+std::array<frame, times> unroll_model(unsigned frames) {
+  stats_reserve(std::size_t{times} * sizeof(unsigned) * (model->maxvar + 1));
+  std::array<frame, times> map;
+  std::vector<job> jobs;
   for (unsigned t = 0; t < times; ++t) {
-    for (unsigned c = 0; c < circuits; ++c) {
-      if (c) { // map the shared latches already in the witness
-        for (auto [w, m] : shared) {
-          map[c][t][m] = map[0][t][w];
-          map[c][t][aiger_not(m)] = map[0][t][aiger_not(w)];
-        }
-      }
-
-      for (unsigned l = 0; l < size[c]; l += 2) {
-        assert(next_lit % 2 == 0);
-        if (map[c][t][l] != INVALID_LIT) continue;
-        if (aiger_is_input(aig[c], l) || aiger_is_latch(aig[c], l))
-          aiger_add_input(check, next_lit, nullptr);
-        else if (aiger_and *a = aiger_is_and(aig[c], l)) {
-          assert(map[c][t][a->rhs0] != INVALID_LIT);
-          assert(map[c][t][a->rhs1] != INVALID_LIT);
-          aiger_add_and(check, next_lit, map[c][t][a->rhs0],
-                        map[c][t][a->rhs1]);
-        } else
-          std::abort();
-        map[c][t][l] = next_lit++;
-        map[c][t][l + 1] = next_lit++;
-      }
-    }
+    frame *m = &(map[t] = make_frame(model));
+    if (t >= frames) continue;
+    const bool transition = t + 1 < frames;
+    jobs.push_back({{m}, [m, transition](arena *a) {
+                      for (unsigned l : roots(model, transition, false))
+                        literal(a, *m, l);
+                    }});
   }
+  encode_concurrently(jobs);
+  return map;
+}
 
+// Copies of the witness over the model frames of `unroll_model`, see
+// `shareable`. Without model frames the shared literals are fresh inputs.
+// Returns map[time]
+std::array<frame, times>
+unroll_witness(const std::vector<std::pair<unsigned, unsigned>> &shared,
+               std::array<frame, times> &model_map, unsigned frames) {
+  stats_reserve(std::size_t{frames} * sizeof(unsigned) *
+                (witness->maxvar + 1));
+  std::array<frame, times> map;
+  std::vector<job> jobs;
+  for (unsigned t = 0; t < frames; ++t) {
+    frame *w = &(map[t] = make_frame(witness));
+    if (model_map[t].c)
+      for (auto [wl, ml] : shared) assign(*w, wl, literal(model_map[t], ml));
+    const bool transition = t + 1 < frames;
+    jobs.push_back({{w}, [w, transition](arena *a) {
+                      for (unsigned l : roots(witness, transition, false))
+                        literal(a, *w, l);
+                    }});
+  }
+  encode_concurrently(jobs);
   return map;
 }
 
-// Encodes the predicates for model and witness at each time step of the
-// unrolling into the check circuit.
-// Returns predicates[circuit][time]{R, RK, F, FK, C, P}
-std::array<std::array<predicates, times>, circuits> encode_predicates(
-    const std::array<std::array<std::vector<unsigned>, times>, circuits> &map,
-    const std::vector<std::pair<unsigned, unsigned>> &shared) {
-  std::array<std::array<predicates, times>, circuits> predicates;
-  std::array<std::vector<aiger_symbol *>, circuits> K;
+// The shared latches of witness and model, K' and K.
+std::array<std::vector<const latch *>, circuits>
+shared_latches(const std::vector<std::pair<unsigned, unsigned>> &shared) {
+  std::array<std::vector<const latch *>, circuits> K;
   K[0].reserve(shared.size());
   K[1].reserve(shared.size());
   for (auto [w, m] : shared) {
-    if (auto *l = aiger_is_latch(witness, w)) K[0].push_back(l);
-    if (auto *l = aiger_is_latch(model, m)) K[1].push_back(l);
+    if (auto *l = is_latch(witness, w)) K[0].push_back(l);
+    if (auto *l = is_latch(model, m)) K[1].push_back(l);
   }
+  return K;
+}
 
-  for (unsigned c = 0; c < circuits; ++c) {
-    for (unsigned t = 0; t < times; ++t) {
-
-      for (auto l : K[c])
-        predicates[c][t].RK =
-            conj(predicates[c][t].RK,
-                 equivalent(map[c][t][l->lit], map[c][t][l->reset]));
-      for (unsigned i = 0; i < aig[c]->num_latches; ++i) {
-        aiger_symbol *l = aig[c]->latches + i;
-        predicates[c][t].R =
-            conj(predicates[c][t].R,
-                 equivalent(map[c][t][l->lit], map[c][t][l->reset]));
-      }
-
-      if (t < times - 1) { // no transitions at last time step
-        for (auto l : K[c])
-          predicates[c][t].FK =
-              conj(predicates[c][t].FK,
-                   equivalent(map[c][t][l->next], map[c][t + 1][l->lit]));
-        for (unsigned i = 0; i < aig[c]->num_latches; ++i) {
-          aiger_symbol *l = aig[c]->latches + i;
-          predicates[c][t].F =
-              conj(predicates[c][t].F,
-                   equivalent(map[c][t][l->next], map[c][t + 1][l->lit]));
-        }
-      }
-
-      for (unsigned i = 0; i < aig[c]->num_constraints; ++i)
-        predicates[c][t].C =
-            conj(predicates[c][t].C, map[c][t][aig[c]->constraints[i].lit]);
-
-      for (unsigned i = 0; i < aig[c]->num_bad; ++i)
-        predicates[c][t].P =
-            conj(predicates[c][t].P, aiger_not(map[c][t][aig[c]->bad[i].lit]));
-      // if neither outputs nor justice is defined assume old aiger
-      if (!aig[c]->num_bad && !aig[c]->num_justice)
-        for (unsigned i = 0; i < aig[c]->num_outputs; ++i)
-          predicates[c][t].P = conj(
-              predicates[c][t].P, aiger_not(map[c][t][aig[c]->outputs[i].lit]));
+// Encodes the predicates for the circuit of `map` at each materialized time
+// step of the unrolling into the check circuit, with P the conjunction of the
+// negated `bad` signals. They do not depend on the witness mapping, see
+// `encode_shared` for those that do.
+// Returns predicates[time]{R, F, C, P}
+std::array<predicates, times> encode_predicates(std::array<frame, times> &map,
+                                                const std::vector<unsigned> &bad,
+                                                unsigned frames) {
+  std::array<predicates, times> predicates;
+  const circuit *c = map[0].c;
+  for (unsigned t = 0; t < frames; ++t) {
+    frame &now = map[t];
+    std::vector<unsigned> R, F, C, P;
+    for (const latch &l : c->latches)
+      R.push_back(equivalent(literal(now, l.lit), literal(now, l.reset)));
+    if (t + 1 < frames) { // no transitions at last time step
+      frame &then = map[t + 1];
+      for (const latch &l : c->latches)
+        F.push_back(equivalent(literal(now, l.next), literal(then, l.lit)));
     }
-  }
+    for (unsigned l : c->constraints) C.push_back(literal(now, l));
+    for (unsigned l : bad) P.push_back(aiger_not(literal(now, l)));
 
+    predicates[t].R = conj_tree(std::move(R));
+    predicates[t].F = conj_tree(std::move(F));
+    predicates[t].C = conj_tree(C);
+    predicates[t].P = conj_tree(std::move(P));
+    predicates[t].Cs = std::move(C);
+  }
   return predicates;
 }
 
-// Encodes the witness rank at time `current` with interventions
-// replaced by their corresponding values from time `next`.
-std::vector<unsigned>
-intervene(const aiger *circuit,
-          const std::vector<std::pair<unsigned, unsigned>> &interventions,
-          const std::vector<unsigned> &current,
-          const std::vector<unsigned> &next) {
-  std::vector<unsigned> intervention_map(2 * (circuit->maxvar + 1),
-                                         INVALID_LIT);
-  auto map = [&intervention_map](unsigned from, unsigned to) {
-    intervention_map.at(from) = to;
-    intervention_map.at(aiger_not(from)) = aiger_not(to);
-  };
-  map(0, 0);
-
-  // Map inputs and latches from current
-  for (unsigned i = 0; i < circuit->num_inputs; ++i) {
-    aiger_symbol *l = circuit->inputs + i;
-    map(l->lit, current.at(l->lit));
-  }
-  for (unsigned i = 0; i < circuit->num_latches; ++i) {
-    aiger_symbol *l = circuit->latches + i;
-    map(l->lit, current.at(l->lit));
-  }
-  // Intervene "next" literals to point to current in next state
-  for (auto [c, n] : interventions) map(n, next.at(c));
-  // Reencode and gates
-  for (unsigned i = 0; i < circuit->num_ands; ++i) {
-    aiger_and *a = circuit->ands + i;
-    assert(intervention_map[a->rhs0] != INVALID_LIT);
-    assert(intervention_map[a->rhs1] != INVALID_LIT);
-    if (intervention_map[a->lhs] != INVALID_LIT) continue;
-    map(a->lhs, conj(intervention_map[a->rhs0], intervention_map[a->rhs1]));
+// Adds the predicates over the shared latches K of the circuit of `map` to
+// those of `encode_predicates`.
+// Sets predicates[time]{RK, FK}
+void encode_shared(std::array<predicates, times> &predicates,
+                   std::array<frame, times> &map,
+                   const std::vector<const latch *> &K, unsigned frames) {
+  for (unsigned t = 0; t < frames; ++t) {
+    frame &now = map[t];
+    std::vector<unsigned> RK, FK;
+    for (auto l : K)
+      RK.push_back(equivalent(literal(now, l->lit), literal(now, l->reset)));
+    if (t + 1 < frames) {
+      frame &then = map[t + 1];
+      for (auto l : K)
+        FK.push_back(equivalent(literal(now, l->next), literal(then, l->lit)));
+    }
+    predicates[t].RK = conj_tree(std::move(RK));
+    predicates[t].FK = conj_tree(FK);
+    predicates[t].FKs = std::move(FK);
   }
+}
 
-  return intervention_map;
+// Frames of the witness rank at time `current` with interventions
+// replaced by their corresponding values from time `next`, for each pair of
+// times in `between`. The cones of the Q lits are encoded concurrently.
+std::vector<frame>
+intervene(const std::vector<std::pair<unsigned, unsigned>> &interventions,
+          std::array<frame, times> &map,
+          const std::vector<std::pair<unsigned, unsigned>> &between) {
+  std::vector<frame> intervened;
+  intervened.reserve(between.size());
+  std::vector<job> jobs;
+  for (auto [current, next] : between) {
+    // the intervened cones only read the inputs and latches of the base
+    // frame, which are encoded here as they are shared by concurrent jobs
+    for (unsigned l : witness->inputs) literal(map[current], l);
+    for (const latch &l : witness->latches) literal(map[current], l.lit);
+    frame *f = &intervened.emplace_back(make_frame(witness, &map[current]));
+    // Intervene "next" literals to point to current in next state
+    for (auto [l, n] : interventions) assign(*f, n, literal(map[next], l));
+    jobs.push_back({{f}, [f](arena *a) {
+                      for (unsigned l : witness->fairness) literal(a, *f, l);
+                      for (const auto &justice : witness->justice)
+                        for (unsigned l : justice) literal(a, *f, l);
+                    }});
+  }
+  encode_concurrently(jobs);
+  return intervened;
 }
 
-std::pair<unsigned, std::vector<unsigned>>
-encode_Q(const aiger *circuit, const std::vector<unsigned> &map) {
-  unsigned predicate{1};
+std::pair<unsigned, std::vector<unsigned>> encode_Q(frame &map) {
+  const circuit *c = map.c;
   std::vector<unsigned> lits;
-  unsigned size = circuit->num_fairness;
-  for (unsigned i = 0; i < circuit->num_justice; i++)
-    size += circuit->justice[i].size;
+  std::size_t size = c->fairness.size();
+  for (const auto &justice : c->justice) size += justice.size();
   lits.reserve(size);
-  unsigned fair{0};
-  for (unsigned i = 0; i < circuit->num_fairness; i++) {
-    unsigned q = aiger_not(map[circuit->fairness[i].lit]);
-    lits.push_back(q);
-    fair = disj(fair, q);
-  }
-  for (unsigned i = 0; i < circuit->num_justice; i++) {
-    unsigned rank{fair};
-    for (unsigned j = 0; j < circuit->justice[i].size; j++) {
-      unsigned q = aiger_not(map[circuit->justice[i].lits[j]]);
+  for (unsigned l : c->fairness) lits.push_back(aiger_not(literal(map, l)));
+  const unsigned fair = disj_tree(lits);
+  std::vector<unsigned> ranks;
+  ranks.reserve(c->justice.size());
+  for (const auto &justice : c->justice) {
+    std::vector<unsigned> rank{fair};
+    for (unsigned l : justice) {
+      unsigned q = aiger_not(literal(map, l));
       lits.push_back(q);
-      rank = disj(rank, q);
+      rank.push_back(q);
     }
-    predicate = conj(predicate, rank);
+    ranks.push_back(disj_tree(std::move(rank)));
   }
   assert(lits.size() == size);
-  return {predicate, lits};
+  return {conj_tree(std::move(ranks)), lits};
 }
 
-// Always match the shape of the model Q (combination of fairness and justice).
+// Always match the shape of the model Q (combination of fairness and justice)
+// of the certified property `p`, whose signals are used in model frames.
 // For each property, additional justice signals in the circuit are ignored,
 // and missing signals are set to 1.
-std::vector<unsigned> flatten_Q_lits(const aiger *circuit,
-                                     const std::vector<unsigned> &map) {
+std::vector<unsigned> flatten_Q_lits(frame &map, const property &p) {
+  const circuit *c = map.c;
+  const auto &fairness = c == model ? p.fairness : c->fairness;
+  const auto &justices = c == model ? p.justice : c->justice;
   std::vector<unsigned> lits;
-  unsigned size = model->num_fairness;
-  for (unsigned i = 0; i < model->num_justice; i++)
-    size += model->justice[i].size;
+  std::size_t size = p.fairness.size();
+  for (const auto &justice : p.justice) size += justice.size();
   lits.reserve(size);
-  for (unsigned i = 0; i < model->num_fairness; i++) {
+  for (std::size_t i = 0; i < p.fairness.size(); i++) {
     unsigned lit{1};
-    if (i < circuit->num_fairness)
-      lit = aiger_not(map[circuit->fairness[i].lit]);
+    if (i < fairness.size()) lit = aiger_not(literal(map, fairness[i]));
     lits.push_back(lit);
   }
-  for (unsigned i = 0; i < model->num_justice; i++) {
-    for (unsigned j = 0; j < model->justice[i].size; j++) {
+  for (std::size_t i = 0; i < p.justice.size(); i++) {
+    for (std::size_t j = 0; j < p.justice[i].size(); j++) {
       unsigned lit{1};
-      if (i < circuit->num_justice && j < circuit->justice[i].size)
-        lit = aiger_not(map[circuit->justice[i].lits[j]]);
+      if (i < justices.size() && j < justices[i].size())
+        lit = aiger_not(literal(map, justices[i][j]));
       lits.push_back(lit);
     }
   }
@@ -443,40 +1135,120 @@ std::vector<unsigned> flatten_Q_lits(const aiger *circuit,
   return lits;
 }
 
+// Splits the conjuncts `terms` into at most `opt.partition` groups of similar
+// size. Terms are assigned one after the other, each to the group whose cones
+// its own cone in the check circuit runs into most often, so terms sharing
+// logic end up together. Linear in the size of the check circuit, since the
+// search of a term stops at variables already reached by an earlier term.
+std::vector<std::vector<unsigned>>
+partition(const std::vector<unsigned> &terms) {
+  const std::size_t groups = std::min<std::size_t>(opt.partition, terms.size());
+  const std::size_t cap = (terms.size() + groups - 1) / groups;
+  const unsigned current = static_cast<unsigned>(groups);
+  std::vector<unsigned> gate(check->maxvar + 1, INVALID_LIT);
+  for (unsigned i = 0; i < check->num_ands; ++i)
+    gate[aiger_lit2var(check->ands[i].lhs)] = i;
+  std::vector<unsigned> owner(check->maxvar + 1, INVALID_LIT);
+  std::vector<std::vector<unsigned>> group(groups);
+  std::vector<unsigned> touched(groups), reached, stack;
+  for (unsigned term : terms) {
+    std::fill(touched.begin(), touched.end(), 0);
+    reached.clear();
+    stack.assign(1, aiger_lit2var(term));
+    while (!stack.empty()) {
+      const unsigned u = stack.back();
+      stack.pop_back();
+      if (!u) continue;
+      if (owner[u] != INVALID_LIT) {
+        if (owner[u] != current) touched[owner[u]]++;
+        continue;
+      }
+      owner[u] = current;
+      reached.push_back(u);
+      if (gate[u] == INVALID_LIT) continue;
+      stack.push_back(aiger_lit2var(check->ands[gate[u]].rhs0));
+      stack.push_back(aiger_lit2var(check->ands[gate[u]].rhs1));
+    }
+    std::size_t best = groups;
+    for (std::size_t g = 0; g < groups; ++g)
+      if (group[g].size() < cap &&
+          (best == groups || touched[g] > touched[best] ||
+           (touched[g] == touched[best] &&
+            group[g].size() < group[best].size())))
+        best = g;
+    group[best].push_back(term);
+    for (unsigned u : reached) owner[u] = static_cast<unsigned>(best);
+  }
+  std::erase_if(group, [](const auto &g) { return g.empty(); });
+  return group;
+}
+
+// Adds the obligation that `implied` is valid as an output of the check circuit
+// named `name`, followed by the name of the property being certified.
+void add_obligation(unsigned implied, std::string name) {
+  if (!certified.back().empty()) name.append("_").append(certified.back());
+  aiger_add_output(check, aiger_not(implied), name.c_str());
+  obligation_property.push_back(static_cast<unsigned>(certified.size() - 1));
+}
+
+// Adds the obligation `antecedent` → `consequent`, where the consequent is the
+// conjunction of `terms`. With --partition it is split into sub-obligations
+// name_1, name_2, ... over groups of the terms, which are unsat iff the whole
+// obligation is, but can be solved independently.
+void add_conjunctive(const char *name, unsigned antecedent,
+                     unsigned consequent, const std::vector<unsigned> &terms) {
+  const auto groups = opt.partition > 1 && terms.size() > 1
+                          ? partition(terms)
+                          : std::vector<std::vector<unsigned>>{};
+  if (groups.size() < 2) {
+    add_obligation(imply(antecedent, consequent), name);
+    return;
+  }
+  for (std::size_t g = 0; g < groups.size(); ++g) {
+    const std::string part = std::string{name} + "_" + std::to_string(g + 1);
+    add_obligation(imply(antecedent, conj_tree(groups[g])), part);
+  }
+}
+
 void simulates(const std::array<predicates, times> &W,
-               const std::array<predicates, times> &M,
-               const std::vector<unsigned> &Qst_lits_witness,
-               const std::vector<unsigned> &Qst_lits_model) {
+               const std::array<predicates, times> &M) {
   { // Reset: R[K] ∧ C → R'[K] ∧ C'
     unsigned reset_antecedent = conj(M[0].RK, M[0].C);
     unsigned reset_consequent = conj(W[0].RK, W[0].C);
     unsigned reset = imply(reset_antecedent, reset_consequent);
-    aiger_add_output(check, aiger_not(reset), "Reset");
+    add_obligation(reset, "Reset");
   }
   { // Transition: Fst[K] ∧ Cs ∧ Ct ∧ C's → F'st[K] ∧ C't
     unsigned transition_antecedent = conj(M[0].FK, M[0].C, M[1].C, W[0].C);
     unsigned transition_consequent = conj(W[0].FK, W[1].C);
-    unsigned transition = imply(transition_antecedent, transition_consequent);
-    aiger_add_output(check, aiger_not(transition), "Transition");
+    std::vector<unsigned> terms(W[0].FKs);
+    terms.insert(terms.end(), W[1].Cs.begin(), W[1].Cs.end());
+    add_conjunctive("Transition", transition_antecedent, transition_consequent,
+                    terms);
   }
   { // Safety: P' ∧ C ∧ C' → P
     unsigned safety_antecedent = conj(M[0].C, W[0].C, W[0].P);
     unsigned safety_consequent = M[0].P;
     unsigned safety = imply(safety_antecedent, safety_consequent);
-    aiger_add_output(check, aiger_not(safety), "Safety");
+    add_obligation(safety, "Safety");
   }
+}
+
+void lives(const std::array<predicates, times> &W,
+           const std::array<predicates, times> &M,
+           const std::vector<unsigned> &Qst_lits_witness,
+           const std::vector<unsigned> &Qst_lits_model) {
   { // Liveness: ∧i∈{s,t}(Ci ∧ C'i ∧ P'i) ∧ F'_st[L'] → ∧q∈Q(q'st → qst)
     unsigned live_guard{1};
     for (unsigned i = 0; i < 2; ++i)
       live_guard = conj(live_guard, M[i].C, W[i].C, W[i].P);
     unsigned live_antecedent = conj(live_guard, W[0].F);
-    unsigned live_consequent{1};
+    std::vector<unsigned> implied;
     assert(Qst_lits_witness.size() == Qst_lits_model.size());
     for (unsigned i = 0; i < Qst_lits_witness.size(); i++)
-      live_consequent =
-          conj(live_consequent, imply(Qst_lits_witness[i], Qst_lits_model[i]));
-    unsigned live = imply(live_antecedent, live_consequent);
-    aiger_add_output(check, aiger_not(live), "Liveness");
+      implied.push_back(imply(Qst_lits_witness[i], Qst_lits_model[i]));
+    unsigned live_consequent = conj_tree(implied);
+    add_conjunctive("Liveness", live_antecedent, live_consequent, implied);
   }
 }
 
@@ -485,13 +1257,13 @@ void inductive(const std::array<predicates, times> &W) {
     unsigned base_antecedent = conj(W[0].R, W[0].C);
     unsigned base_consequent = W[0].P;
     unsigned base = imply(base_antecedent, base_consequent);
-    aiger_add_output(check, aiger_not(base), "Base");
+    add_obligation(base, "Base");
   }
   { // Inductive: F'st[L'] ∧ C's ∧ C't ∧ P's → P't
     unsigned inductive_antecedent = conj(W[0].F, W[0].C, W[1].C, W[0].P);
     unsigned inductive_consequent = W[1].P;
     unsigned inductive = imply(inductive_antecedent, inductive_consequent);
-    aiger_add_output(check, aiger_not(inductive), "Inductive");
+    add_obligation(inductive, "Inductive");
   }
 }
 
@@ -508,7 +1280,7 @@ void ranked(const std::array<predicates, times> &W, //
     unsigned decrease_antecedent = conj(decrease_guard, W[0].F);
     unsigned decrease_consequent = Qts;
     unsigned decrease = imply(decrease_antecedent, decrease_consequent);
-    aiger_add_output(check, aiger_not(decrease), "Decrease");
+    add_obligation(decrease, "Decrease");
   }
   { // Closure: ∧i∈{s,t,u}(C'i ∧ P'i) ∧ F'st[L'] ∧ Q'su → Q'tu
     unsigned closure_guard{1};
@@ -517,7 +1289,7 @@ void ranked(const std::array<predicates, times> &W, //
     unsigned closure_antecedent = conj(closure_guard, W[0].F, Qsu);
     unsigned closure_consequent = Qtu;
     unsigned closure = imply(closure_antecedent, closure_consequent);
-    aiger_add_output(check, aiger_not(closure), "Closure");
+    add_obligation(closure, "Closure");
   }
   { // Consistent: ∧i∈{s,t,u}(C'i ∧ P'i) ∧ F'st[L'] ∧ F'tu[L']
     // ∧ Q'st ∧ Q'tu → ∧q∈Q(q'st → q'tu)
@@ -526,40 +1298,439 @@ void ranked(const std::array<predicates, times> &W, //
       consistent_guard = conj(consistent_guard, W[i].C, W[i].P);
     unsigned consistent_antecedent =
         conj(consistent_guard, W[0].F, W[1].F, Qst, Qtu);
-    unsigned consistent_consequent{1};
+    std::vector<unsigned> implied;
     assert(Qst_lits.size() == Qtu_lits.size());
     for (unsigned i = 0; i < Qst_lits.size(); i++)
-      consistent_consequent =
-          conj(consistent_consequent, imply(Qst_lits[i], Qtu_lits[i]));
-    unsigned consistent = imply(consistent_antecedent, consistent_consequent);
-    aiger_add_output(check, aiger_not(consistent), "Consistent");
+      implied.push_back(imply(Qst_lits[i], Qtu_lits[i]));
+    unsigned consistent_consequent = conj_tree(implied);
+    add_conjunctive("Consistent", consistent_antecedent, consistent_consequent,
+                    implied);
   }
 }
 
-} // namespace
+// Simulates the check circuit on random input patterns. The first obligation
+// that evaluates to true is reported with the values of the inputs and
+// latches of witness and model in each frame of `map`, if given, as
+// counterexample, 'x' for those outside of all obligations. Returns false if
+// an obligation was refuted.
+bool simulated(const std::array<std::array<frame, times>, circuits> *map,
+               unsigned frames) {
+  constexpr unsigned patterns{64 * lanes};
+  const unsigned passes = (opt.simulate + patterns - 1) / patterns;
+  std::mt19937_64 random;
+  std::vector<word> values(lanes * (check->maxvar + 1));
+  for (unsigned pass = 0; pass < passes; ++pass) {
+    for (unsigned i = 0; i < check->num_inputs; ++i)
+      for (unsigned w = 0; w < lanes; ++w)
+        values[lanes * aiger_lit2var(check->inputs[i].lit) + w] = random();
+    simulate(check, values);
+    for (unsigned o = 0; o < check->num_outputs; ++o) {
+      word out[lanes];
+      literal_words(values, check->outputs[o].lit, out);
+      const auto w = std::find_if(out, out + lanes, [](word x) { return x; });
+      if (w == out + lanes) continue;
+      const unsigned lane = static_cast<unsigned>(w - out);
+      const unsigned bit = static_cast<unsigned>(std::countr_zero(*w));
+      auto value = [&](const frame &f, unsigned lit) {
+        const auto encoded_lit = encoded(f, lit);
+        if (!encoded_lit) return 'x';
+        word l[lanes];
+        literal_words(values, *encoded_lit, l);
+        return static_cast<char>('0' + (l[lane] >> bit & 1));
+      };
+      std::cout << "Simulation refuted " << check->outputs[o].name << "\n";
+      for (unsigned c = 0; map && c < circuits; ++c)
+        for (unsigned t = 0; t < frames && (*map)[c][t].c; ++t) {
+          std::string inputs, latches;
+          for (unsigned l : aig[c]->inputs) inputs += value((*map)[c][t], l);
+          for (const latch &l : aig[c]->latches)
+            latches += value((*map)[c][t], l.lit);
+          std::cout << (c ? "model" : "witness") << " time " << t
+                    << " inputs " << inputs << " latches " << latches << "\n";
+        }
+      return false;
+    }
+  }
+  std::cout << "Simulated " << passes * patterns
+            << " random patterns without refuting an obligation\n";
+  return true;
+}
 
-int main(int argc, char *argv[]) {
-  auto check_path = initialize(argc, argv);
+// True if the witness has to be checked for the liveness part of `p`.
+bool live(const property &p) {
+  return !p.fairness.empty() || !p.justice.empty() || liveness(witness);
+}
+
+// Number of time frames needed to certify `p`.
+unsigned time_frames(const property &p) {
+  return live(p) && opt.obligations & RANKED ? 3 : 2;
+}
+
+// Adds the obligations certifying the property `p` of the model with frames
+// `Wmap` over the model frames `Mmap`, whose predicates for `p` may have been
+// encoded before.
+void add_obligations(
+    std::array<frame, times> &Wmap, std::array<frame, times> &Mmap,
+    const std::vector<std::pair<unsigned, unsigned>> &shared,
+    const std::vector<std::pair<unsigned, unsigned>> &interventions,
+    const property &p,
+    const std::array<predicates, times> *model_predicates = nullptr) {
+  const bool simulation = opt.obligations & SIMULATION;
+  const bool induction = opt.obligations & INDUCTIVE;
+  const unsigned frames = time_frames(p);
+  const bool ranking = frames == 3;
+  stats_phase("encode_predicates", check->num_ands);
+  const auto K = shared_latches(shared);
+  auto W = encode_predicates(Wmap, safety(witness), frames);
+  encode_shared(W, Wmap, K[0], frames);
+  std::array<predicates, times> M;
+  if (simulation) {
+    M = model_predicates ? *model_predicates
+                         : encode_predicates(Mmap, p.bad, frames);
+    encode_shared(M, Mmap, K[1], frames);
+  }
+  std::vector<frame> intervened; // st, tu, su, ts
+  if (live(p) && (simulation || ranking)) {
+    stats_phase("intervene", check->num_ands);
+    std::vector<std::pair<unsigned, unsigned>> between{{0, 1}};
+    if (ranking) between.insert(between.end(), {{1, 2}, {0, 2}, {1, 0}});
+    intervened = intervene(interventions, Wmap, between);
+  }
+
+  if (simulation) {
+    stats_phase("simulation", check->num_ands);
+    simulates(W, M);
+    if (live(p))
+      lives(W, M, flatten_Q_lits(intervened[0], p),
+            flatten_Q_lits(Mmap[0], p));
+  }
+  if (induction) {
+    stats_phase("inductive", check->num_ands);
+    inductive(W);
+  }
+  if (ranking) {
+    stats_phase("ranked", check->num_ands);
+    const auto [Qst, Qst_lits] = encode_Q(intervened[0]);
+    const auto [Qtu, Qtu_lits] = encode_Q(intervened[1]);
+    const auto Qsu = encode_Q(intervened[2]).first;
+    const auto Qts = encode_Q(intervened[3]).first;
+    ranked(W, Qst, Qtu, Qsu, Qts, Qst_lits, Qtu_lits);
+  }
+}
+
+// A model of a batch unrolled into its own check circuit, kept resident for
+// the workers certifying its witnesses, with the predicates of all its
+// properties for the number of `frames` it needs on its own.
+struct resident {
+  circuit *model;
+  aiger *check;
+  unsigned next_lit;
+  std::unordered_map<std::uint64_t, unsigned> strash;
+  std::array<frame, times> map;
+  unsigned frames;
+  std::array<predicates, times> M;
+};
+
+// Exchanges the model and check circuit with those of the resident, calling
+// it twice restores them.
+void swap(resident &r) {
+  std::swap(model, r.model);
+  std::swap(check, r.check);
+  std::swap(next_lit, r.next_lit);
+  strash.swap(r.strash);
+}
+
+// Unrolls the model `m` into a new check circuit, see `resident`.
+resident unroll_resident(circuit *m) {
+  resident r{m, aiger_init(), 2, {}, {},
+             liveness(m) && opt.obligations & RANKED ? 3u : 2u, {}};
+  if (!model_needed()) return r;
+  swap(r);
+  stats_phase("unroll", check->num_ands);
+  r.map = unroll_model(r.frames);
+  stats_phase("encode_predicates", check->num_ands);
+  r.M = encode_predicates(r.map, safety(model), r.frames);
+  swap(r);
+  return r;
+}
+
+// Certifies the witness against the model, returns the exit code. The model
+// may already be unrolled into the check circuit, then its frames are shared
+// unless the mapping is not `shareable`.
+int certify(const char *check_path, resident *unrolled = nullptr) {
+  if (!unrolled) check = aiger_init();
   if (!stratified(witness))
     std::cerr << "Witness resets not stratified\n", exit(1);
   const auto [shared, interventions] = read_mapping();
-  const auto map = unroll(shared);
-  const auto map_st = intervene(witness, interventions, map[0][0], map[0][1]);
-  const auto map_tu = intervene(witness, interventions, map[0][1], map[0][2]);
-  const auto map_su = intervene(witness, interventions, map[0][0], map[0][2]);
-  const auto map_ts = intervene(witness, interventions, map[0][1], map[0][0]);
-
-  const auto [W, M] = encode_predicates(map, shared);
-  const auto [Qst, Qst_lits] = encode_Q(witness, map_st);
-  const auto [Qtu, Qtu_lits] = encode_Q(witness, map_tu);
-  const auto Qsu = encode_Q(witness, map_su).first;
-  const auto Qts = encode_Q(witness, map_ts).first;
-  const auto Qst_lits_witness = flatten_Q_lits(witness, map_st);
-  const auto Qst_lits_model = flatten_Q_lits(model, map[1][0]);
-
-  simulates(W, M, Qst_lits_witness, Qst_lits_model);
-  inductive(W);
-  ranked(W, Qst, Qtu, Qsu, Qts, Qst_lits, Qtu_lits);
-
-  finalize(check_path);
+  const property all = all_properties();
+  if (!live(all)) std::cout << "No liveness properties, skipping Liveness and "
+                               "ranking obligations\n";
+  stats_phase("unroll", check->num_ands);
+  const unsigned frames = time_frames(all);
+  std::array<std::array<frame, times>, circuits> map;
+  if (unrolled && shareable(shared)) {
+    map[1] = std::move(unrolled->map);
+    map[0] = unroll_witness(shared, map[1], frames);
+    add_obligations(map[0], map[1], shared, interventions, all,
+                    unrolled->frames == frames ? &unrolled->M
+                                               : nullptr);
+  } else {
+    if (unrolled)
+      std::cout << "Mapping not shareable, unrolling the model again\n";
+    map = unroll(shared, frames, live(all) && opt.obligations & SIMULATION);
+    add_obligations(map[0], map[1], shared, interventions, all);
+  }
+
+  if (opt.simulate) {
+    stats_phase("simulate", check->num_ands);
+    if (!simulated(&map, frames)) {
+      std::cout << "Certificate check failed\n";
+      return conclude(false);
+    }
+  }
+  return finalize(check_path);
+}
+
+// Certifies the property named in the WITNESS comment of each witness, see
+// `witnessed_property`, in a single check circuit. The model is unrolled once
+// and the witnesses, read one after the other, share its frames unless their
+// mapping is not `shareable`. The obligations are named after the property,
+// e.g. Safety_b3, and with --solve a result is reported per property.
+int certify_properties(const char *check_path) {
+  check = aiger_init();
+  certified.clear();
+  const bool ranking = liveness(model) && opt.obligations & RANKED;
+  stats_phase("unroll", check->num_ands);
+  auto model_map = model_needed() ? unroll_model(ranking ? 3 : 2)
+                                  : std::array<frame, times>{};
+  for (std::size_t i = 0; i < witnesses.size(); ++i) {
+    aig[0] = witness = new circuit;
+    const std::string err = load(witness, witnesses[i], "witness");
+    if (!err.empty()) std::cerr << err << '\n', exit(1);
+    if (!stratified(witness))
+      std::cerr << "Witness '" << witnesses[i] << "' resets not stratified\n",
+          exit(1);
+    property p = witnessed_property();
+    if (p.name.empty()) p.name = "w" + std::to_string(i);
+    if (std::find(certified.begin(), certified.end(), p.name) !=
+        certified.end())
+      std::cerr << "Error: property " << p.name << " certified twice\n",
+          exit(1);
+    certified.push_back(p.name);
+    std::cout << "Certifying property " << p.name << " with witness '"
+              << witnesses[i] << "'\n";
+    const auto [shared, interventions] = read_mapping();
+    stats_phase("unroll", check->num_ands);
+    if (shareable(shared)) {
+      auto map = unroll_witness(shared, model_map, time_frames(p));
+      add_obligations(map, model_map, shared, interventions, p);
+    } else {
+      std::cout << "Mapping not shareable, unrolling the model again\n";
+      auto map = unroll(shared, time_frames(p),
+                        live(p) && opt.obligations & SIMULATION);
+      add_obligations(map[0], map[1], shared, interventions, p);
+    }
+    delete witness;
+    aig[0] = witness = nullptr;
+  }
+
+  if (opt.simulate) {
+    stats_phase("simulate", check->num_ands);
+    if (!simulated(nullptr, 0)) {
+      std::cout << "Certificate check failed\n";
+      return conclude(false);
+    }
+  }
+  return finalize(check_path);
+}
+
+// Certifies the pairs "model witness [check]" listed one per line in the
+// manifest or on stdin. Each pair is checked by a forked worker with the
+// options of the batch, at most `opt.workers` at once, as soon as its line is
+// read. Each model is read and unrolled once when it is first named and kept
+// resident, so the workers inherit its frames and predicates, see
+// `resident`. Without --solve the check circuit of a pair defaults to the
+// witness path with _check.aig. Prints one line per pair when it finishes,
+// also while waiting for more lines on stdin: model, witness, result
+// (passed, failed, written or error) and time. With --stats=file.json the
+// statistics of the n-th pair are written to file_n.json. Returns 0 if no
+// pair failed.
+int batch() {
+  constexpr int FAILED{2}; // exit status of a worker refuting its pair
+  const int manifest = opt.manifest ? open(opt.manifest, O_RDONLY) : 0;
+  if (manifest < 0)
+    std::cerr << "Error reading manifest '" << opt.manifest << "'\n", exit(1);
+  struct task {
+    std::string model, witness;
+    std::FILE *log;
+    std::chrono::steady_clock::time_point start;
+  };
+  std::unordered_map<std::string, std::pair<resident, std::string>> models;
+  std::unordered_map<pid_t, task> running;
+  unsigned unsuccessful{}, pairs{};
+  auto report = [&](const task &j, const char *result, std::string_view why) {
+    const std::chrono::duration<double> time =
+        std::chrono::steady_clock::now() - j.start;
+    std::cout << j.model << ' ' << j.witness << ' ' << result << ' '
+              << std::fixed << std::setprecision(2) << time.count() << 's';
+    if (!why.empty()) std::cout << ' ' << why;
+    std::cout << std::endl;
+    if (std::strcmp(result, "passed") && std::strcmp(result, "written"))
+      unsuccessful++;
+  };
+  // Reports a finished worker, waiting for one unless `flags` is WNOHANG.
+  // Returns false if none finished.
+  auto finish = [&](int flags) {
+    int status{};
+    const pid_t pid = waitpid(-1, &status, flags);
+    const auto it = running.find(pid);
+    if (pid <= 0 || it == running.end()) return false;
+    const task &j = it->second;
+    std::string log;
+    std::rewind(j.log);
+    for (int c; (c = std::fgetc(j.log)) != EOF;)
+      log.push_back(static_cast<char>(c));
+    std::fclose(j.log);
+    std::string_view last{log};
+    while (last.ends_with('\n')) last.remove_suffix(1);
+    last.remove_prefix(std::min(last.rfind('\n') + 1, last.size()));
+    if (!WIFEXITED(status))
+      report(j, "error",
+             "killed by signal " + std::to_string(WTERMSIG(status)));
+    else if (!WEXITSTATUS(status))
+      report(j, opt.solve ? "passed" : "written", {});
+    else if (WEXITSTATUS(status) == FAILED) report(j, "failed", {});
+    else report(j, "error", last);
+    running.erase(it);
+    return true;
+  };
+  // Reads the next line, reporting the workers finishing in the meantime.
+  std::string buffer;
+  bool end{};
+  auto next = [&](std::string &line) {
+    for (;;) {
+      if (const auto newline = buffer.find('\n'); newline != buffer.npos) {
+        line = buffer.substr(0, newline);
+        buffer.erase(0, newline + 1);
+        return true;
+      }
+      if (end) {
+        line = std::move(buffer);
+        buffer.clear();
+        return !line.empty();
+      }
+      pollfd input{manifest, POLLIN, 0};
+      while (!running.empty() && !poll(&input, 1, 10))
+        while (finish(WNOHANG)) {}
+      char chunk[1 << 12];
+      const ssize_t n = read(manifest, chunk, sizeof chunk);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) end = true;
+      else buffer.append(chunk, static_cast<std::size_t>(n));
+    }
+  };
+
+  for (std::string line; next(line);) {
+    std::istringstream fields{line};
+    std::string check_path;
+    task pair{};
+    if (!(fields >> pair.model) || pair.model.starts_with('#')) continue;
+    pairs++;
+    fields >> pair.witness;
+    pair.start = std::chrono::steady_clock::now();
+    if (pair.witness.empty()) {
+      report(pair, "error", "missing witness");
+      continue;
+    }
+    if (!(fields >> check_path))
+      check_path = obligation_path(pair.witness, "check", ".aig");
+    auto [it, first] = models.try_emplace(pair.model);
+    auto &[unrolled, err] = it->second;
+    if (first) {
+      auto *m = new circuit;
+      err = load(m, pair.model.c_str(), "model");
+      if (err.empty()) unrolled = unroll_resident(m);
+      else delete m;
+    }
+    if (!err.empty()) {
+      report(pair, "error", err);
+      continue;
+    }
+    while (running.size() >= opt.workers) finish(0);
+    pair.log = std::tmpfile();
+    if (!pair.log) std::cerr << "Error: can not create worker log\n", exit(1);
+    std::cout.flush();
+    const pid_t pid = fork();
+    if (pid < 0) std::cerr << "Error: can not fork worker\n", exit(1);
+    if (!pid) {
+      dup2(fileno(pair.log), STDOUT_FILENO);
+      dup2(fileno(pair.log), STDERR_FILENO);
+      swap(unrolled);
+      std::string json{opt.json ? opt.json : ""};
+      auto dot = json.rfind('.');
+      if (dot == json.npos || json.find('/', dot) != json.npos) dot = json.size();
+      json.insert(dot, "_" + std::to_string(pairs));
+      if (opt.json) opt.json = json.c_str();
+      stats_restart("initialize", check->num_ands);
+      witness = new circuit;
+      aig = {witness, model};
+      const std::string error = load(witness, pair.witness.c_str(), "witness");
+      if (!error.empty()) std::cerr << error << '\n', exit(1);
+      exit(certify(check_path.c_str(), &unrolled) ? FAILED : 0);
+    }
+    running.emplace(pid, std::move(pair));
+  }
+  while (!running.empty()) finish(0);
+  if (opt.manifest) close(manifest);
+  for (auto &[path, loaded] : models) {
+    auto &[unrolled, err] = loaded;
+    if (!err.empty()) continue;
+    aiger_reset(unrolled.check);
+    delete unrolled.model;
+  }
+  std::cout << "Certified " << pairs << " pairs, " << unsuccessful
+            << " not successful\n";
+  return unsuccessful ? 1 : 0;
+}
+
+// Checks the binary LRAT proof refuting the DIMACS formula given with
+// --check-lrat, e.g. one written by an external solver, returns the exit code.
+int check_proof() {
+  cnf formula;
+  if (const char *err = read_dimacs(formula, formula_path))
+    std::cerr << "Error reading formula '" << formula_path << "': " << err
+              << '\n',
+        exit(1);
+  std::FILE *proof = std::fopen(proof_path, "rb");
+  if (!proof)
+    std::cerr << "Error reading proof '" << proof_path << "'\n", exit(1);
+  const std::string rejected = check_lrat(formula, proof);
+  std::fclose(proof);
+  if (!rejected.empty()) {
+    std::cout << "Proof rejected: " << rejected << '\n';
+    return 1;
+  }
+  std::cout << "Proof checked\n";
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  stats_phase("initialize", 0);
+  auto check_path = initialize(argc, argv);
+  if (opt.lrat) return check_proof();
+  if (opt.batch) return batch();
+  if (opt.properties) return certify_properties(check_path);
+  if (opt.trace) {
+    std::vector<unsigned> order;
+    if (!stratified(model, &order))
+      std::cerr << "Model resets not stratified\n", exit(1);
+    stats_phase("trace", 0);
+    const bool passed = check_traces(model, order, traces);
+    if (opt.stats) print_stats(opt.json, 0);
+    delete model;
+    return passed ? 0 : 1;
+  }
+  return certify(check_path);
 }
@@ -0,0 +1,220 @@
+#include "circuit.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+// Cursor into the mapped file. All parse functions return false on error.
+struct reader {
+  const char *p, *end;
+
+  bool number(unsigned &n) {
+    if (p == end || *p < '0' || *p > '9') return false;
+    std::uint64_t v{};
+    while (p != end && *p >= '0' && *p <= '9')
+      if ((v = 10 * v + static_cast<unsigned>(*p++ - '0')) > ~0u) return false;
+    n = static_cast<unsigned>(v);
+    return true;
+  }
+  bool expect(char c) { return p != end && *p == c && ++p; }
+  // Delta of the binary and section, 7 bits per byte, least significant first
+  bool delta(unsigned &d) {
+    std::uint64_t v{};
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+      if (p == end) return false;
+      const auto byte = static_cast<unsigned char>(*p++);
+      v |= std::uint64_t{byte & 0x7fu} << shift;
+      if (!(byte & 0x80)) {
+        d = static_cast<unsigned>(v);
+        return v <= ~0u;
+      }
+    }
+    return false;
+  }
+  std::string_view line() {
+    const char *newline = std::find(p, end, '\n');
+    const std::string_view l{p, static_cast<std::size_t>(newline - p)};
+    p = newline == end ? end : newline + 1;
+    return l;
+  }
+};
+
+bool has_mapping(std::string_view name) {
+  return name.find_first_of("=<") != std::string_view::npos;
+}
+
+// Decodes a binary AIGER file. The header has already been checked.
+const char *decode(circuit *c, reader r) {
+  unsigned header[9]{}, fields{};
+  while (fields < 9) {
+    if (!r.number(header[fields++])) return "invalid header";
+    if (r.expect('\n')) break;
+    if (!r.expect(' ')) return "invalid header";
+  }
+  if (fields < 5 || r.p[-1] != '\n') return "invalid header";
+  const auto [M, I, L, O, A, B, C, J, F] = header;
+  if (std::uint64_t{I} + L + A != M) return "invalid maximal variable index";
+  if (M >= 1u << 31) return "maximal variable index too large";
+  c->maxvar = M;
+  const unsigned max_lit = 2 * M + 1;
+  auto literal = [&](unsigned &lit) { return r.number(lit) && lit <= max_lit; };
+  auto lits = [&](std::vector<unsigned> &v, unsigned n) {
+    v.resize(n);
+    for (unsigned &l : v)
+      if (!literal(l) || !r.expect('\n')) return false;
+    return true;
+  };
+
+  c->inputs.resize(I);
+  for (unsigned i = 0; i < I; ++i) c->inputs[i] = 2 * (i + 1);
+  c->latches.resize(L);
+  for (unsigned i = 0; i < L; ++i) {
+    latch &l = c->latches[i];
+    l.lit = 2 * (I + i + 1), l.reset = 0;
+    if (!literal(l.next)) return "invalid latch";
+    if (r.expect(' ') && !literal(l.reset)) return "invalid latch reset";
+    if (!r.expect('\n')) return "invalid latch";
+  }
+  if (!lits(c->outputs, O)) return "invalid output";
+  if (!lits(c->bad, B)) return "invalid bad state property";
+  if (!lits(c->constraints, C)) return "invalid constraint";
+  std::vector<unsigned> sizes(J);
+  for (unsigned &s : sizes)
+    if (!r.number(s) || !r.expect('\n')) return "invalid justice size";
+  c->justice.resize(J);
+  for (unsigned j = 0; j < J; ++j)
+    if (!lits(c->justice[j], sizes[j])) return "invalid justice property";
+  if (!lits(c->fairness, F)) return "invalid fairness constraint";
+
+  c->ands.resize(A);
+  for (unsigned i = 0; i < A; ++i) {
+    aiger_and &a = c->ands[i];
+    a.lhs = 2 * (I + L + i + 1);
+    unsigned d0, d1;
+    if (!r.delta(d0) || !r.delta(d1) || !d0 || d0 > a.lhs || d1 > a.lhs - d0)
+      return "invalid and";
+    a.rhs0 = a.lhs - d0, a.rhs1 = a.rhs0 - d1;
+  }
+
+  while (r.p != r.end) {
+    const std::string_view line = r.line();
+    if (line == "c") {
+      c->comments = {r.p, static_cast<std::size_t>(r.end - r.p)};
+      break;
+    }
+    if (line.empty() || (line[0] != 'i' && line[0] != 'l')) continue;
+    const auto space = line.find(' ');
+    const std::string_view name = line.substr(std::min(space, line.size()));
+    if (space == std::string_view::npos || !has_mapping(name)) continue;
+    reader index{line.data() + 1, line.data() + space};
+    unsigned i;
+    if (!index.number(i) || index.p != index.end ||
+        i >= (line[0] == 'i' ? I : L))
+      return "invalid symbol";
+    const unsigned lit = 2 * (i + 1 + (line[0] == 'i' ? 0 : I));
+    c->symbols.emplace_back(lit, name.substr(1));
+  }
+  std::sort(c->symbols.begin(), c->symbols.end());
+  return nullptr;
+}
+
+// Copies a circuit read by the AIGER library.
+void copy(circuit *c, aiger *aig) {
+  c->maxvar = aig->maxvar;
+  for (unsigned i = 0; i < aig->num_inputs; ++i)
+    c->inputs.push_back(aig->inputs[i].lit);
+  for (unsigned i = 0; i < aig->num_latches; ++i) {
+    const aiger_symbol &l = aig->latches[i];
+    c->latches.push_back({l.lit, l.next, l.reset});
+  }
+  c->ands.assign(aig->ands, aig->ands + aig->num_ands);
+  std::sort(c->ands.begin(), c->ands.end(),
+            [](const aiger_and &a, const aiger_and &b) {
+              return a.lhs < b.lhs;
+            });
+  auto lits = [](std::vector<unsigned> &v, aiger_symbol *s, unsigned n) {
+    for (unsigned i = 0; i < n; ++i) v.push_back(s[i].lit);
+  };
+  lits(c->outputs, aig->outputs, aig->num_outputs);
+  lits(c->bad, aig->bad, aig->num_bad);
+  lits(c->constraints, aig->constraints, aig->num_constraints);
+  lits(c->fairness, aig->fairness, aig->num_fairness);
+  for (unsigned j = 0; j < aig->num_justice; ++j)
+    c->justice.emplace_back(aig->justice[j].lits,
+                            aig->justice[j].lits + aig->justice[j].size);
+
+  // Names and comments are copied into one string, viewed once it is complete
+  std::vector<std::pair<unsigned, std::size_t>> names;
+  auto keep = [&](const aiger_symbol *s, unsigned n) {
+    for (unsigned i = 0; i < n; ++i) {
+      if (!s[i].name || !has_mapping(s[i].name)) continue;
+      names.emplace_back(s[i].lit, c->storage.size());
+      c->storage.append(s[i].name).push_back('\0');
+    }
+  };
+  keep(aig->inputs, aig->num_inputs);
+  keep(aig->latches, aig->num_latches);
+  const std::size_t comments = c->storage.size();
+  for (char **p = aig->comments; p && *p; ++p)
+    c->storage.append(*p).push_back('\n');
+  c->comments = std::string_view{c->storage}.substr(comments);
+  for (auto [lit, offset] : names)
+    c->symbols.emplace_back(lit, c->storage.data() + offset);
+  std::sort(c->symbols.begin(), c->symbols.end());
+
+  // positions are needed unless the variables are numbered consecutively
+  bool consecutive =
+      c->maxvar == c->inputs.size() + c->latches.size() + c->ands.size();
+  unsigned var{};
+  for (unsigned l : c->inputs) consecutive &= l == aiger_var2lit(++var);
+  for (const latch &l : c->latches)
+    consecutive &= l.lit == aiger_var2lit(++var);
+  for (const aiger_and &a : c->ands)
+    consecutive &= a.lhs == aiger_var2lit(++var);
+  if (consecutive) return;
+  c->position.resize(c->maxvar + 1);
+  unsigned i{};
+  for (unsigned l : c->inputs) c->position[aiger_lit2var(l)] = ++i;
+  for (const latch &l : c->latches) c->position[aiger_lit2var(l.lit)] = ++i;
+  for (const aiger_and &a : c->ands) c->position[aiger_lit2var(a.lhs)] = ++i;
+}
+
+} // namespace
+
+circuit::~circuit() {
+  if (mapping) munmap(mapping, mapped);
+}
+
+const char *read_circuit(circuit *c, const char *path) {
+  const int fd = open(path, O_RDONLY);
+  struct stat status {};
+  if (fd >= 0 && !fstat(fd, &status) && status.st_size > 4) {
+    c->mapped = static_cast<std::size_t>(status.st_size);
+    void *mapping = mmap(nullptr, c->mapped, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      const char *data = static_cast<const char *>(mapping);
+      if (!std::memcmp(data, "aig ", 4)) {
+        close(fd);
+        c->mapping = mapping;
+        madvise(mapping, c->mapped, MADV_SEQUENTIAL);
+        return decode(c, {data + 4, data + c->mapped});
+      }
+      munmap(mapping, c->mapped);
+    }
+  }
+  if (fd >= 0) close(fd);
+  aiger *aig = aiger_init();
+  static std::string error; // the message is owned by the library
+  const char *err = aiger_open_and_read_from_file(aig, path);
+  if (err) error = err;
+  else copy(c, aig);
+  aiger_reset(aig);
+  return err ? error.c_str() : nullptr;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "aiger.h"
+
+struct latch {
+  unsigned lit, next, reset;
+};
+
+// A model or witness in flat arrays. Binary AIGER files are memory mapped and
+// decoded in place, the names are views into the mapping. Of the symbol table
+// only the names of inputs and latches containing '=' or '<' are kept.
+struct circuit {
+  unsigned maxvar{};
+  std::vector<unsigned> inputs;
+  std::vector<latch> latches;
+  std::vector<aiger_and> ands; // ordered by lhs
+  std::vector<unsigned> outputs, bad, constraints, fairness;
+  std::vector<std::vector<unsigned>> justice;
+  std::vector<std::pair<unsigned, std::string_view>> symbols; // sorted by lit
+  std::string_view comments; // lines after the symbol table
+
+  // Position of each variable in inputs, latches and ands plus one. Empty if
+  // the variables are numbered consecutively in that order as in binary AIGER.
+  std::vector<unsigned> position;
+  std::string storage; // names and comments of circuits not memory mapped
+  void *mapping{};
+  std::size_t mapped{};
+
+  circuit() = default;
+  circuit(const circuit &) = delete;
+  circuit &operator=(const circuit &) = delete;
+  ~circuit();
+};
+
+// Reads an AIGER circuit. Binary files are decoded directly, ASCII and
+// compressed files are read with the AIGER library. Returns an error message
+// or nullptr.
+const char *read_circuit(circuit *c, const char *path);
+
+// Index of `lit` in the concatenation of inputs, latches and ands, or an
+// index past the end if it is a constant or not a variable of `c`.
+inline std::size_t position(const circuit *c, unsigned lit) {
+  const unsigned var = aiger_lit2var(lit);
+  if (c->position.empty()) return var ? var - std::size_t{1} : std::size_t(-1);
+  if (var >= c->position.size()) return std::size_t(-1);
+  return c->position[var] - std::size_t{1};
+}
+
+inline bool is_input(const circuit *c, unsigned lit) {
+  return position(c, lit) < c->inputs.size();
+}
+
+inline const latch *is_latch(const circuit *c, unsigned lit) {
+  const std::size_t i = position(c, lit) - c->inputs.size();
+  return i < c->latches.size() ? c->latches.data() + i : nullptr;
+}
+
+inline const aiger_and *is_and(const circuit *c, unsigned lit) {
+  const std::size_t i =
+      position(c, lit) - c->inputs.size() - c->latches.size();
+  return i < c->ands.size() ? c->ands.data() + i : nullptr;
+}
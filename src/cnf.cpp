@@ -0,0 +1,123 @@
+#include "cnf.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <string>
+
+namespace {
+
+constexpr unsigned char POSITIVE{1}, NEGATIVE{2};
+
+unsigned char flip(unsigned char polarity) {
+  return static_cast<unsigned char>((polarity & POSITIVE) << 1 |
+                                    (polarity & NEGATIVE) >> 1);
+}
+
+} // namespace
+
+cnf encode(const aiger *circuit, const std::vector<unsigned> &roots,
+           bool polarity) {
+  std::vector<unsigned char> occurs(circuit->maxvar + 1);
+  for (unsigned lit : roots)
+    occurs[aiger_lit2var(lit)] |= aiger_sign(lit) ? NEGATIVE : POSITIVE;
+  cnf formula;
+  for (unsigned i = circuit->num_ands; i-- > 0;) {
+    const aiger_and *a = circuit->ands + i;
+    unsigned char &p = occurs[aiger_lit2var(a->lhs)];
+    if (!p) continue;
+    if (!polarity) p = POSITIVE | NEGATIVE;
+    formula.clauses += (p & POSITIVE ? 2 : 0) + (p & NEGATIVE ? 1 : 0);
+    for (unsigned rhs : {a->rhs0, a->rhs1})
+      occurs[aiger_lit2var(rhs)] |= aiger_sign(rhs) ? flip(p) : p;
+  }
+  // constants are encoded as a variable fixed to false
+  if (occurs[0]) formula.clauses++;
+
+  std::vector<int> index(circuit->maxvar + 1);
+  for (unsigned v = 0; v <= circuit->maxvar; ++v)
+    if (occurs[v]) index[v] = static_cast<int>(++formula.variables);
+  auto dimacs = [&index](unsigned l) {
+    const int v = index[aiger_lit2var(l)];
+    return aiger_sign(l) ? -v : v;
+  };
+
+  formula.literals.reserve(3 * formula.clauses + 2 * roots.size());
+  auto add = [&formula](std::initializer_list<int> clause) {
+    formula.literals.insert(formula.literals.end(), clause);
+    formula.literals.push_back(0);
+  };
+  if (occurs[0]) add({-index[0]});
+  for (unsigned i = 0; i < circuit->num_ands; ++i) {
+    const aiger_and *a = circuit->ands + i;
+    const unsigned char p = occurs[aiger_lit2var(a->lhs)];
+    if (!p) continue;
+    const int g = dimacs(a->lhs), s = dimacs(a->rhs0), t = dimacs(a->rhs1);
+    if (p & POSITIVE) add({-g, s}), add({-g, t});
+    if (p & NEGATIVE) add({g, -s, -t});
+  }
+  formula.roots.reserve(roots.size());
+  for (unsigned lit : roots) formula.roots.push_back(dimacs(lit));
+  return formula;
+}
+
+cnf encode(const aiger *circuit, unsigned lit, bool polarity) {
+  cnf formula = encode(circuit, std::vector<unsigned>{lit}, polarity);
+  formula.literals.push_back(formula.roots.front());
+  formula.literals.push_back(0);
+  formula.clauses++;
+  return formula;
+}
+
+bool write_dimacs(const cnf &formula, const char *path) {
+  FILE *file = std::fopen(path, "w");
+  if (!file) return false;
+  std::string buffer;
+  buffer.reserve(1 << 16);
+  buffer.append("p cnf ")
+      .append(std::to_string(formula.variables))
+      .append(" ")
+      .append(std::to_string(formula.clauses))
+      .append("\n");
+  char number[16];
+  for (int l : formula.literals) {
+    const auto end = std::to_chars(number, number + sizeof number, l).ptr;
+    buffer.append(number, end).push_back(l ? ' ' : '\n');
+    if (buffer.size() < (1 << 16) - 32) continue;
+    std::fwrite(buffer.data(), 1, buffer.size(), file);
+    buffer.clear();
+  }
+  std::fwrite(buffer.data(), 1, buffer.size(), file);
+  const bool failed = std::ferror(file);
+  return !std::fclose(file) && !failed;
+}
+
+const char *read_dimacs(cnf &formula, const char *path) {
+  FILE *file = std::fopen(path, "r");
+  if (!file) return "cannot open";
+  formula = {};
+  int c;
+  while ((c = std::getc(file)) == 'c')
+    while ((c = std::getc(file)) != '\n' && c != EOF) {}
+  std::ungetc(c, file);
+  const char *error{};
+  if (std::fscanf(file, " p cnf %u %u", &formula.variables,
+                  &formula.clauses) != 2)
+    error = "invalid header";
+  unsigned clauses{};
+  int read{}, lit;
+  while (!error && (read = std::fscanf(file, "%d", &lit)) == 1) {
+    if (static_cast<unsigned>(std::abs(lit)) > formula.variables)
+      error = "invalid literal";
+    formula.literals.push_back(lit);
+    if (!lit) clauses++;
+  }
+  if (!error && read != EOF) error = "invalid literal";
+  else if (!error && !formula.literals.empty() && formula.literals.back())
+    error = "unterminated clause";
+  else if (!error && clauses != formula.clauses)
+    error = "clause count does not match header";
+  std::fclose(file);
+  return error;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+#include "aiger.h"
+
+// Clauses of a Tseitin encoded cone, each terminated by a zero as in DIMACS.
+struct cnf {
+  unsigned variables{}, clauses{};
+  std::vector<int> literals;
+  std::vector<int> roots; // DIMACS literals of the encoded roots
+};
+
+// Encodes the union of the cones of `roots` without asserting them, which
+// allows checking each root incrementally under assumptions.
+cnf encode(const aiger *circuit, const std::vector<unsigned> &roots,
+           bool polarity);
+
+// Encodes the cone of influence of `lit` in a combinatorial circuit whose ands
+// are in topological order and asserts `lit`. Variables are numbered densely
+// in circuit order. With `polarity` (Plaisted-Greenbaum) only the clauses
+// needed for the polarities a gate occurs in are added.
+cnf encode(const aiger *circuit, unsigned lit, bool polarity);
+
+// Writes the clauses in DIMACS format, returns false on failure.
+bool write_dimacs(const cnf &formula, const char *path);
+
+// Reads the clauses of a DIMACS file, returns an error message or nullptr.
+const char *read_dimacs(cnf &formula, const char *path);
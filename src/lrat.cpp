@@ -0,0 +1,193 @@
+#include "lrat.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Buffered reader of the numbers in a binary proof, each mapped to 2 * |n|
+// plus one if negative and written in groups of 7 bits, least significant
+// first, with the high bit set on all but the last group.
+struct reader {
+  std::FILE *file;
+  unsigned char buffer[1 << 16]{};
+  std::size_t size{}, position{};
+
+  int get() {
+    if (position == size) {
+      position = 0;
+      if (!(size = std::fread(buffer, 1, sizeof buffer, file))) return EOF;
+    }
+    return buffer[position++];
+  }
+
+  // Returns false at the end of the proof or if the number overflows.
+  bool number(std::uint64_t &n) {
+    n = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      const int c = get();
+      if (c == EOF) return false;
+      n |= std::uint64_t(c & 0x7f) << shift;
+      if (!(c & 0x80)) return true;
+    }
+    return false;
+  }
+
+  void drain() {
+    while (std::fread(buffer, 1, sizeof buffer, file)) {}
+    size = position = 0;
+  }
+};
+
+struct checker {
+  const cnf &formula;
+  std::vector<std::size_t> original; // offset of each original clause
+  std::vector<bool> deleted;         // of the original clauses
+  // offset and size of the derived clauses alive in `pool`, by id
+  std::unordered_map<std::uint64_t, std::pair<std::size_t, unsigned>> derived;
+  std::vector<int> pool;
+  std::size_t garbage{};
+  std::vector<signed char> values; // by variable, 1 if true, -1 if false
+  std::vector<unsigned> trail;     // assigned variables
+};
+
+// Literals of the clause `id` if it is alive.
+bool lookup(const checker &c, std::uint64_t id, const int *&lits,
+            unsigned &size) {
+  if (id && id <= c.original.size()) {
+    if (c.deleted[id - 1]) return false;
+    lits = c.formula.literals.data() + c.original[id - 1];
+    for (size = 0; lits[size]; ++size) {}
+    return true;
+  }
+  const auto it = c.derived.find(id);
+  if (it == c.derived.end()) return false;
+  lits = c.pool.data() + it->second.first;
+  size = it->second.second;
+  return true;
+}
+
+signed char value(const checker &c, int lit) {
+  const signed char v = c.values[static_cast<unsigned>(std::abs(lit))];
+  return static_cast<signed char>(lit < 0 ? -v : v);
+}
+
+void assign(checker &c, int lit) {
+  const auto v = static_cast<unsigned>(std::abs(lit));
+  c.values[v] = lit < 0 ? -1 : 1;
+  c.trail.push_back(v);
+}
+
+// Checks that assigning the negation of `clause` and propagating the hints in
+// order runs into a conflict. Returns an error message or nullptr.
+const char *implied(checker &c, const std::vector<int> &clause,
+                    const std::vector<std::uint64_t> &hints) {
+  const char *error{"hints do not run into a conflict"};
+  bool tautology{};
+  for (int lit : clause) {
+    if (value(c, lit) > 0) tautology = true;
+    else if (!value(c, lit)) assign(c, -lit);
+  }
+  if (tautology) error = nullptr;
+  for (std::size_t h = 0; error && h < hints.size(); ++h) {
+    const int *lits;
+    unsigned size, unassigned{};
+    int unit{};
+    if (!lookup(c, hints[h], lits, size)) {
+      error = "hint to a missing clause";
+      break;
+    }
+    bool satisfied{};
+    for (unsigned i = 0; !satisfied && i < size; ++i) {
+      const signed char v = value(c, lits[i]);
+      if (v > 0) satisfied = true;
+      else if (!v) unassigned++, unit = lits[i];
+    }
+    if (satisfied) continue;
+    if (!unassigned) error = nullptr;
+    else if (unassigned == 1) assign(c, unit);
+    else error = "hint is not unit";
+  }
+  for (unsigned v : c.trail) c.values[v] = 0;
+  c.trail.clear();
+  return error;
+}
+
+// Moves the derived clauses alive to the front of the pool.
+void compact(checker &c) {
+  std::vector<int> pool;
+  pool.reserve(c.pool.size() - c.garbage);
+  for (auto &[id, clause] : c.derived) {
+    const auto begin = c.pool.begin() + static_cast<long>(clause.first);
+    clause.first = pool.size();
+    pool.insert(pool.end(), begin, begin + clause.second);
+  }
+  c.pool = std::move(pool);
+  c.garbage = 0;
+}
+
+} // namespace
+
+std::string check_lrat(const cnf &formula, std::FILE *proof) {
+  checker c{formula, {}, {}, {}, {}, {}, {}, {}};
+  c.original.reserve(formula.clauses);
+  for (std::size_t i = 0; i < formula.literals.size(); ++i)
+    if (!i || !formula.literals[i - 1]) c.original.push_back(i);
+  c.deleted.resize(c.original.size());
+  c.values.resize(formula.variables + 1);
+
+  reader r{proof};
+  std::vector<int> clause;
+  std::vector<std::uint64_t> hints;
+  auto reject = [&r](std::string why) {
+    r.drain();
+    return why;
+  };
+  for (int kind; (kind = r.get()) != EOF;) {
+    std::uint64_t n;
+    if (kind == 'd') {
+      while (r.number(n) && n) {
+        const std::uint64_t id = n / 2;
+        if (id && id <= c.original.size()) c.deleted[id - 1] = true;
+        else if (const auto it = c.derived.find(id); it != c.derived.end()) {
+          c.garbage += it->second.second;
+          c.derived.erase(it);
+        }
+      }
+      if (c.garbage > (1u << 16) && 2 * c.garbage > c.pool.size()) compact(c);
+      continue;
+    }
+    if (kind != 'a') return reject("invalid binary LRAT proof");
+    std::uint64_t id;
+    if (!r.number(id) || (id /= 2) <= c.original.size() ||
+        c.derived.contains(id))
+      return reject("invalid clause id");
+    clause.clear(), hints.clear();
+    bool complete;
+    while ((complete = r.number(n)) && n) {
+      // only the variables of the formula, no extension variables
+      if (n < 2 || n / 2 > formula.variables)
+        return reject("invalid literal");
+      const int lit = static_cast<int>(n / 2);
+      clause.push_back(n & 1 ? -lit : lit);
+    }
+    while (complete && (complete = r.number(n)) && n) {
+      if (n & 1) return reject("RAT hints are not supported");
+      hints.push_back(n / 2);
+    }
+    if (!complete) return reject("truncated proof");
+    if (const char *error = implied(c, clause, hints))
+      return reject("clause " + std::to_string(id) + ": " + error);
+    if (clause.empty()) {
+      r.drain();
+      return {};
+    }
+    c.derived.emplace(id, std::pair{c.pool.size(),
+                                    static_cast<unsigned>(clause.size())});
+    c.pool.insert(c.pool.end(), clause.begin(), clause.end());
+  }
+  return "no empty clause derived";
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+#include "cnf.hpp"
+
+// Checks a binary LRAT proof refuting `formula` while it is read from `proof`,
+// e.g. a pipe the solver writes to. The original clauses are taken from the
+// formula with the ids 1, 2, ... in order, each added clause has to follow by
+// unit propagation over its hints in order. Only clauses not deleted yet are
+// kept, so the memory is bounded by the clauses alive in the solver. The proof
+// is always read to the end. Returns an empty string if the empty clause was
+// derived, otherwise why the proof was rejected.
+std::string check_lrat(const cnf &formula, std::FILE *proof);
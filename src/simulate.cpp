@@ -0,0 +1,22 @@
+#include "simulate.hpp"
+
+#include <algorithm>
+
+void simulate(const aiger *circuit, std::vector<word> &values) {
+  values.resize(lanes * (circuit->maxvar + 1));
+  std::fill_n(values.begin(), lanes, word{});
+  for (unsigned i = 0; i < circuit->num_ands; ++i) {
+    const aiger_and *a = circuit->ands + i;
+    word s[lanes], t[lanes];
+    literal_words(values, a->rhs0, s);
+    literal_words(values, a->rhs1, t);
+    word *lhs = values.data() + lanes * aiger_lit2var(a->lhs);
+    for (unsigned w = 0; w < lanes; ++w) lhs[w] = s[w] & t[w];
+  }
+}
+
+void literal_words(const std::vector<word> &values, unsigned lit, word *out) {
+  const word *v = values.data() + lanes * aiger_lit2var(lit);
+  const word mask = aiger_sign(lit) ? ~word{} : word{};
+  for (unsigned w = 0; w < lanes; ++w) out[w] = v[w] ^ mask;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "aiger.h"
+
+// Number of 64-bit words simulated per variable in one pass. The loops over
+// the words are simple enough to be vectorized by the compiler.
+constexpr unsigned lanes{4};
+using word = std::uint64_t;
+
+// Bit-parallel simulation of a combinatorial circuit whose ands are in
+// topological order. `values` holds `lanes` words for each variable; the
+// words of the inputs have to be set, those of the ands are computed.
+void simulate(const aiger *circuit, std::vector<word> &values);
+
+// Simulated words of a literal.
+void literal_words(const std::vector<word> &values, unsigned lit, word *out);
@@ -0,0 +1,209 @@
+#include "solve.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include "cnf.hpp"
+#include "lrat.hpp"
+#include "stats.hpp"
+
+#if defined(EMBED_KISSAT)
+extern "C" {
+#include "kissat.h"
+}
+#elif defined(EMBED_CADICAL)
+#include "cadical.hpp"
+#endif
+
+namespace {
+
+std::atomic<bool> interrupted;
+
+// Returns 10 for satisfiable, 20 for unsatisfiable, and 0 if interrupted.
+// With `rejected`, the LRAT proof of the solver is piped into `check_lrat`
+// on its own thread while solving, and why it was rejected is stored.
+int sat(const cnf &formula, std::string *rejected) {
+#if defined(EMBED_KISSAT)
+  kissat *solver = kissat_init();
+  kissat_set_option(solver, "quiet", 1);
+  kissat_set_terminate(solver, nullptr, [](void *) -> int {
+    return interrupted.load(std::memory_order_relaxed);
+  });
+  kissat_reserve(solver, static_cast<int>(formula.variables));
+  for (int l : formula.literals) kissat_add(solver, l);
+  const int res = kissat_solve(solver);
+  kissat_release(solver);
+  (void)rejected;
+  return res;
+#elif defined(EMBED_CADICAL)
+  struct : CaDiCaL::Terminator {
+    bool terminate() override {
+      return interrupted.load(std::memory_order_relaxed);
+    }
+  } terminator;
+  CaDiCaL::Solver solver;
+  solver.set("quiet", 1);
+  std::FILE *trace{};
+  std::thread checker;
+  if (rejected) {
+    int fds[2];
+    if (pipe(fds)) std::cerr << "Error: can not create proof pipe\n", exit(1);
+    // factor adds extension variables, which check_lrat does not support
+    solver.set("lrat", 1), solver.set("binary", 1), solver.set("factor", 0);
+    trace = fdopen(fds[1], "w");
+    solver.trace_proof(trace, "<pipe>");
+    checker = std::thread{[&formula, rejected, proof = fdopen(fds[0], "r")] {
+      *rejected = check_lrat(formula, proof);
+      std::fclose(proof);
+    }};
+  }
+  solver.connect_terminator(&terminator);
+  for (int l : formula.literals) solver.add(l);
+  const int res = solver.solve();
+  solver.disconnect_terminator();
+  if (rejected) {
+    solver.close_proof_trace();
+    std::fclose(trace);
+    checker.join();
+  }
+  return res;
+#else
+  (void)formula, (void)rejected;
+  return 0;
+#endif
+}
+
+// Prints the result of an obligation, returns true if it was unsatisfiable.
+// With `rejected`, the proof was checked and is only accepted if empty.
+bool report(std::mutex &log, const obligation &o, int res,
+            std::chrono::steady_clock::time_point start,
+            const std::string *rejected = nullptr) {
+  const std::chrono::duration<double> time =
+      std::chrono::steady_clock::now() - start;
+  const bool unsat = res == 20 && (!rejected || rejected->empty());
+  stats_solved(o.name, time.count(), unsat);
+  const std::lock_guard lock{log};
+  std::cout << o.name
+            << (res == 20 ? ": unsat " : res == 10 ? ": SAT " : ": unknown ")
+            << time.count() << 's';
+  if (res == 20 && rejected)
+    std::cout << (unsat ? " proof checked" : " proof rejected: ") << *rejected;
+  std::cout << '\n';
+  return unsat;
+}
+
+} // namespace
+
+const char *embedded_solver() {
+#if defined(EMBED_KISSAT)
+  return kissat_signature();
+#elif defined(EMBED_CADICAL)
+  return CaDiCaL::Solver::signature();
+#else
+  return nullptr;
+#endif
+}
+
+bool embedded_lrat() {
+#if defined(EMBED_CADICAL)
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool solve(const aiger *circuit, std::vector<obligation> obligations,
+           unsigned threads, bool polarity, bool proofs,
+           std::vector<bool> *refuted) {
+  if (obligations.empty()) return true;
+  interrupted = false; // by the first sat obligation of an earlier call
+  std::stable_sort(obligations.begin(), obligations.end(),
+                   [](const obligation &a, const obligation &b) {
+                     return a.cone > b.cone;
+                   });
+  threads = std::clamp(threads, 1u, static_cast<unsigned>(obligations.size()));
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "Solving " << obligations.size() << " obligations with "
+            << embedded_solver() << " on " << threads << " threads\n";
+  std::mutex log;
+  std::atomic<std::size_t> next{};
+  std::atomic<bool> passed{true};
+  auto work = [&] {
+    for (std::size_t i; !interrupted && (i = next++) < obligations.size();) {
+      const obligation &o = obligations[i];
+      if (refuted) {
+        const std::lock_guard lock{log};
+        if ((*refuted)[o.property]) continue;
+      }
+      const auto start = std::chrono::steady_clock::now();
+      std::string rejected;
+      const int res =
+          sat(encode(circuit, o.lit, polarity), proofs ? &rejected : nullptr);
+      // an obligation left unsolved without an interrupt has not passed
+      if (!res && interrupted) continue;
+      if (report(log, o, res, start, proofs ? &rejected : nullptr)) continue;
+      passed = false;
+      if (!refuted) interrupted = true;
+      else {
+        const std::lock_guard lock{log};
+        (*refuted)[o.property] = true;
+      }
+    }
+  };
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work);
+  work();
+  for (auto &thread : pool) thread.join();
+  return passed;
+}
+
+bool embedded_incremental() {
+#if defined(EMBED_CADICAL)
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool solve_incremental(const aiger *circuit,
+                       const std::vector<obligation> &obligations,
+                       bool polarity, std::vector<bool> *refuted) {
+  std::vector<unsigned> roots;
+  roots.reserve(obligations.size());
+  for (const obligation &o : obligations) roots.push_back(o.lit);
+  const cnf formula = encode(circuit, roots, polarity);
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "Solving " << obligations.size() << " obligations with "
+            << embedded_solver() << " incrementally on " << formula.variables
+            << " variables " << formula.clauses << " clauses\n";
+#if defined(EMBED_CADICAL)
+  CaDiCaL::Solver solver;
+  solver.set("quiet", 1);
+  for (int l : formula.literals) solver.add(l);
+  std::mutex log;
+  bool passed{true};
+  for (std::size_t i = 0; i < obligations.size(); ++i) {
+    const obligation &o = obligations[i];
+    if (refuted && (*refuted)[o.property]) continue;
+    const auto start = std::chrono::steady_clock::now();
+    solver.assume(formula.roots[i]);
+    if (report(log, o, solver.solve(), start)) continue;
+    if (!refuted) return false;
+    passed = false, (*refuted)[o.property] = true;
+  }
+  return passed;
+#else
+  (void)formula, (void)refuted;
+  return false;
+#endif
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include "aiger.h"
+
+// An output of the check circuit that has to be unsatisfiable.
+struct obligation {
+  const char *name;
+  unsigned lit;
+  unsigned cone; // number of ands in the cone of influence
+  unsigned property{}; // index of the property the obligation belongs to
+};
+
+// Name of the SAT solver linked into certifaiger or nullptr.
+const char *embedded_solver();
+
+// True if the embedded SAT solver can stream LRAT proofs to `check_lrat`.
+bool embedded_lrat();
+
+// Checks that all obligations are unsatisfiable with the embedded SAT solver.
+// The obligations are encoded from memory and solved on at most `threads`
+// threads, largest cone first. With `proofs`, an unsat result only counts if
+// the LRAT proof of the solver is accepted by the in-process checker. Stops at
+// the first satisfiable obligation, unless `refuted` is given with an entry
+// per property. Then a satisfiable obligation only marks its property and
+// skips its remaining obligations.
+bool solve(const aiger *circuit, std::vector<obligation> obligations,
+           unsigned threads, bool polarity, bool proofs,
+           std::vector<bool> *refuted = nullptr);
+
+// True if the embedded SAT solver supports solving under assumptions.
+bool embedded_incremental();
+
+// Checks all obligations with a single instance of the embedded SAT solver.
+// The union of their cones is encoded once and each obligation is solved
+// under the assumption of its output, so learned clauses about the shared
+// unrolling carry over between obligations. `refuted` as for `solve`.
+bool solve_incremental(const aiger *circuit,
+                       const std::vector<obligation> &obligations,
+                       bool polarity, std::vector<bool> *refuted = nullptr);
@@ -0,0 +1,186 @@
+#include "stats.hpp"
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct phase {
+  const char *name;
+  double wall{}, cpu{};
+  long peak{}; // kilobytes the phase grew the peak resident memory by
+  long ands{}; // negative if the phase removed ands
+};
+
+struct obligation {
+  const char *name;
+  unsigned inputs{}, ands{}, depth{};
+  double seconds{-1}; // negative if not solved
+  bool unsat{};
+};
+
+std::vector<phase> phases;
+std::vector<obligation> obligations;
+std::mutex lock;
+
+std::size_t current{}; // index of the running phase plus one
+std::chrono::steady_clock::time_point wall_start{
+    std::chrono::steady_clock::now()};
+double cpu_start{};
+long peak_start{};
+unsigned ands_start{};
+long budget{}; // kilobytes, zero if unlimited
+
+// CPU time of all threads in seconds and peak resident set size in kilobytes
+std::pair<double, long> usage() {
+  rusage r{};
+  getrusage(RUSAGE_SELF, &r);
+  auto seconds = [](timeval t) {
+    return static_cast<double>(t.tv_sec) +
+           static_cast<double>(t.tv_usec) / 1e6;
+  };
+#ifdef __APPLE__
+  const long peak = r.ru_maxrss / 1024;
+#else
+  const long peak = r.ru_maxrss;
+#endif
+  return {seconds(r.ru_utime) + seconds(r.ru_stime), peak};
+}
+
+std::size_t find_phase(const char *name) {
+  for (std::size_t i = 0; i < phases.size(); ++i)
+    if (!std::strcmp(phases[i].name, name)) return i;
+  phases.push_back({name});
+  return phases.size() - 1;
+}
+
+obligation &find_obligation(const char *name) {
+  for (obligation &o : obligations)
+    if (!std::strcmp(o.name, name)) return o;
+  return obligations.emplace_back(obligation{name});
+}
+
+void end_phase(unsigned ands) {
+  const auto now = std::chrono::steady_clock::now();
+  const auto [cpu, peak] = usage();
+  if (current) {
+    phase &p = phases[current - 1];
+    p.wall += std::chrono::duration<double>(now - wall_start).count();
+    p.cpu += cpu - cpu_start;
+    p.peak += peak - peak_start;
+    p.ands += static_cast<long>(ands) - static_cast<long>(ands_start);
+  }
+  wall_start = now, cpu_start = cpu, peak_start = peak, ands_start = ands;
+}
+
+// Prints a string as JSON, the names in this program need no escaping.
+void quoted(std::ostream &out, const char *s) { out << '"' << s << '"'; }
+
+} // namespace
+
+void stats_phase(const char *name, unsigned ands) {
+  end_phase(ands);
+  current = find_phase(name) + 1;
+  stats_reserve(0);
+}
+
+void stats_restart(const char *name, unsigned ands) {
+  phases.clear();
+  obligations.clear();
+  current = 0;
+  stats_phase(name, ands);
+}
+
+void stats_budget(unsigned megabytes) { budget = 1024L * megabytes; }
+
+void stats_reserve(std::size_t bytes) {
+  if (!budget) return;
+  const long peak = usage().second;
+  const long needed = peak + static_cast<long>(bytes / 1024);
+  if (needed <= budget) return;
+  std::cerr << "Error: memory budget of " << budget / 1024 << " MB exceeded";
+  if (current) std::cerr << " in phase " << phases[current - 1].name;
+  std::cerr << " (" << peak / 1024 << " MB peak";
+  if (bytes) std::cerr << ", " << bytes / (1024 * 1024) << " MB more needed";
+  std::cerr << ")\n";
+  exit(1);
+}
+
+void stats_cone(const char *name, unsigned inputs, unsigned ands,
+                unsigned depth) {
+  const std::lock_guard guard{lock};
+  obligation &o = find_obligation(name);
+  o.inputs = inputs, o.ands = ands, o.depth = depth;
+}
+
+void stats_solved(const char *name, double seconds, bool unsat) {
+  const std::lock_guard guard{lock};
+  obligation &o = find_obligation(name);
+  o.seconds = seconds, o.unsat = unsat;
+}
+
+void print_stats(const char *json, unsigned ands) {
+  end_phase(ands);
+  current = 0;
+  // the peak of the process, including its memory before the first phase
+  phase total{"total", 0, 0, usage().second, 0};
+  for (const phase &p : phases)
+    total.wall += p.wall, total.cpu += p.cpu, total.ands += p.ands;
+  if (!json) {
+    std::cout << std::fixed << std::setprecision(2);
+    auto print = [](const phase &p, const char *growth) {
+      std::cout << "Phase " << p.name << ": " << p.wall << "s wall " << p.cpu
+                << "s cpu " << growth << p.peak / 1024 << " MB peak "
+                << p.ands << " ands\n";
+    };
+    for (const phase &p : phases) print(p, "+");
+    print(total, "");
+    for (const obligation &o : obligations) {
+      std::cout << "Obligation " << o.name << ": " << o.inputs << " inputs "
+                << o.ands << " ands depth " << o.depth;
+      if (o.seconds >= 0)
+        std::cout << " " << o.seconds << "s " << (o.unsat ? "unsat" : "SAT");
+      std::cout << "\n";
+    }
+    return;
+  }
+  std::ofstream out{json};
+  out << std::fixed << std::setprecision(6);
+  auto print = [&out](const phase &p, const char *peak) {
+    out << "{\"name\":";
+    quoted(out, p.name);
+    out << ",\"wall\":" << p.wall << ",\"cpu\":" << p.cpu << ",\"" << peak
+        << "\":" << p.peak << ",\"ands\":" << p.ands << "}";
+  };
+  out << "{\"version\":";
+  quoted(out, VERSION);
+  out << ",\"phases\":[";
+  for (std::size_t i = 0; i < phases.size(); ++i)
+    out << (i ? "," : ""), print(phases[i], "peak_growth_kb");
+  out << "],\"total\":";
+  print(total, "peak_kb");
+  out << ",\"obligations\":[";
+  for (std::size_t i = 0; i < obligations.size(); ++i) {
+    const obligation &o = obligations[i];
+    out << (i ? "," : "") << "{\"name\":";
+    quoted(out, o.name);
+    out << ",\"inputs\":" << o.inputs << ",\"ands\":" << o.ands
+        << ",\"depth\":" << o.depth;
+    if (o.seconds >= 0)
+      out << ",\"seconds\":" << o.seconds << ",\"result\":\""
+          << (o.unsat ? "unsat" : "sat") << "\"";
+    out << "}";
+  }
+  out << "]}\n";
+  if (!out.flush())
+    std::cerr << "Error writing statistics to '" << json << "'\n", exit(1);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+// Ends the current phase and starts measuring wall time, CPU time and the
+// growth of the peak memory of the phase `name`. The peak is a high-water
+// mark of the whole process, so a phase only grows it by what it needs beyond
+// all earlier phases. `ands` is the number of ands in the check circuit so
+// far, the difference is attributed to the ending phase, which is negative if
+// the phase reduced the circuit. Phases with the same name accumulate.
+void stats_phase(const char *name, unsigned ands);
+
+// Discards all statistics so far and starts the phase `name`, e.g. in a
+// forked process whose CPU time and peak memory are counted from zero again.
+void stats_restart(const char *name, unsigned ands);
+
+// Limits the peak resident memory to `megabytes`. Exceeding the budget ends
+// the process with an error instead of leaving it to the OOM killer. It is
+// checked at the start of each phase and by `stats_reserve`.
+void stats_budget(unsigned megabytes);
+
+// Exits with an error if `bytes` more than the peak memory so far exceed the
+// budget. Called before large allocations and periodically while encoding.
+void stats_reserve(std::size_t bytes);
+
+// Records the size of the cone of influence of an obligation and the length
+// of the longest path of ands from its output to an input.
+void stats_cone(const char *obligation, unsigned inputs, unsigned ands,
+                unsigned depth);
+
+// Records the result of solving an obligation in-process. Thread safe.
+void stats_solved(const char *obligation, double seconds, bool unsat);
+
+// Ends the current phase and prints the statistics as text, or writes them as
+// a single line of JSON to the file `json` if given, so the log stays apart.
+void print_stats(const char *json, unsigned ands);
@@ -0,0 +1,208 @@
+#include "sweep.hpp"
+
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "simulate.hpp"
+
+#if defined(EMBED_CADICAL)
+#include "cadical.hpp"
+#endif
+
+namespace {
+
+constexpr unsigned NONE = ~0u;
+
+// Signature words per variable: random patterns followed by counterexamples,
+// which are collected until their words are full. Each counterexample costs
+// a pass over the swept circuit, so their number is bounded.
+constexpr unsigned words{2 * lanes};
+constexpr unsigned counterexamples{64 * lanes};
+
+// Incremental solver over the Tseitin encoding of the swept ands, with one
+// solver variable per and, merged or not, and per input.
+struct prover {
+#if defined(EMBED_CADICAL)
+  CaDiCaL::Solver solver;
+#endif
+  unsigned conflicts;
+  int variables{};
+
+  explicit prover(unsigned limit) : conflicts{limit} {
+#if defined(EMBED_CADICAL)
+    solver.set("quiet", 1);
+#endif
+  }
+};
+
+int fresh(prover &p) { return ++p.variables; }
+
+void define(prover &p, int x, int s, int t) {
+#if defined(EMBED_CADICAL)
+  for (int l : {-x, s, 0, -x, t, 0, x, -s, -t, 0}) p.solver.add(l);
+#else
+  (void)p, (void)x, (void)s, (void)t;
+#endif
+}
+
+// Returns 20 if the assumptions are unsatisfiable, 10 if satisfiable and 0
+// if the conflict limit was hit.
+int check(prover &p, std::initializer_list<int> assumptions) {
+#if defined(EMBED_CADICAL)
+  for (int l : assumptions) p.solver.assume(l);
+  p.solver.limit("conflicts", static_cast<int>(p.conflicts));
+  return p.solver.solve();
+#else
+  (void)p, (void)assumptions;
+  return 0;
+#endif
+}
+
+bool value(prover &p, int v) {
+#if defined(EMBED_CADICAL)
+  return v <= p.solver.vars() && p.solver.val(v) > 0;
+#else
+  (void)p, (void)v;
+  return false;
+#endif
+}
+
+std::uint64_t mix(std::uint64_t x) {
+  x ^= x >> 30, x *= 0xbf58476d1ce4e5b9;
+  x ^= x >> 27, x *= 0x94d049bb133111eb;
+  return x ^ x >> 31;
+}
+
+} // namespace
+
+aiger *sweep(const aiger *circuit, unsigned conflicts) {
+  aiger *swept = aiger_init();
+  prover p{conflicts};
+  std::vector<unsigned> lits(circuit->maxvar + 1);
+  std::vector<int> variable{0}; // solver variable per swept variable
+  std::vector<word> sig(words); // signature words per swept variable
+  unsigned next_lit{2}, found{}, merged{}, refuted{}, undecided{};
+  auto resolve = [&lits](unsigned l) {
+    return lits[aiger_lit2var(l)] ^ aiger_sign(l);
+  };
+  auto dimacs = [&variable](unsigned l) {
+    const int v = variable[aiger_lit2var(l)];
+    return aiger_sign(l) ? -v : v;
+  };
+
+  std::mt19937_64 random;
+  for (unsigned i = 0; i < circuit->num_inputs; ++i) {
+    lits[aiger_lit2var(circuit->inputs[i].lit)] = next_lit;
+    aiger_add_input(swept, next_lit, nullptr);
+    next_lit += 2;
+    variable.push_back(fresh(p));
+    for (unsigned w = 0; w < lanes; ++w) sig.push_back(random());
+    sig.resize(sig.size() + lanes);
+  }
+
+  // Classes of simulation equivalent variables, keyed by the hash of the
+  // signature normalized to a false first pattern. The representative is
+  // the first variable of a class, with the sign matching the normalization.
+  std::unordered_map<std::uint64_t, unsigned> classes;
+  auto hash = [](const word *s) {
+    const word mask = s[0] & 1 ? ~word{} : word{};
+    std::uint64_t h{};
+    for (unsigned w = 0; w < words; ++w) h = mix(h + (s[w] ^ mask));
+    return h;
+  };
+  auto same = [](const word *s, const word *t) {
+    const word mask = (s[0] ^ t[0]) & 1 ? ~word{} : word{};
+    for (unsigned w = 0; w < words; ++w)
+      if (s[w] != (t[w] ^ mask)) return false;
+    return true;
+  };
+  auto classify = [&](unsigned v) {
+    const word *s = sig.data() + words * v;
+    const unsigned sign = static_cast<unsigned>(s[0] & 1);
+    classes.try_emplace(hash(s), aiger_var2lit(v) ^ sign);
+  };
+  auto reclassify = [&] {
+    classes.clear();
+    for (unsigned v = 0; v < variable.size(); ++v) classify(v);
+  };
+  reclassify();
+
+  std::unordered_map<std::uint64_t, unsigned> strash;
+  for (unsigned i = 0; i < circuit->num_ands; ++i) {
+    const aiger_and *a = circuit->ands + i;
+    unsigned &lhs = lits[aiger_lit2var(a->lhs)];
+    unsigned s = resolve(a->rhs0), t = resolve(a->rhs1);
+    if (s < t) std::swap(s, t);
+    if (!t || s == aiger_not(t)) {
+      lhs = 0;
+      continue;
+    }
+    if (t == 1 || s == t) {
+      lhs = s;
+      continue;
+    }
+    const std::uint64_t key{std::uint64_t{s} << 32 | t};
+    if (const auto it = strash.find(key); it != strash.end()) {
+      lhs = it->second;
+      continue;
+    }
+
+    word x[words];
+    const unsigned vs = aiger_lit2var(s), vt = aiger_lit2var(t);
+    for (unsigned w = 0; w < words; ++w)
+      x[w] = (sig[words * vs + w] ^ (aiger_sign(s) ? ~word{} : word{})) &
+             (sig[words * vt + w] ^ (aiger_sign(t) ? ~word{} : word{}));
+    const int g = fresh(p);
+    define(p, g, dimacs(s), dimacs(t));
+    unsigned equal{NONE};
+    for (;;) {
+      const auto it = classes.find(hash(x));
+      if (it == classes.end()) break;
+      const unsigned r = it->second ^ static_cast<unsigned>(x[0] & 1);
+      const word *rs = sig.data() + words * aiger_lit2var(r);
+      if (!same(x, rs)) break;
+      int res;
+      if (aiger_is_constant(r)) res = check(p, {r ? -g : g});
+      else if ((res = check(p, {g, -dimacs(r)})) == 20)
+        res = check(p, {-g, dimacs(r)});
+      if (res == 20) {
+        equal = r, merged++;
+        break;
+      }
+      if (!res) undecided++;
+      else refuted++;
+      if (!res || found == counterexamples) break;
+      // the counterexample tells the candidate apart from the and
+      const unsigned w = lanes + found / 64;
+      const word bit = word{1} << found++ % 64;
+      for (unsigned v = 1; v < variable.size(); ++v)
+        if (value(p, variable[v])) sig[words * v + w] |= bit;
+      if (value(p, g)) x[w] |= bit;
+      reclassify();
+    }
+    if (equal != NONE) {
+      lhs = equal;
+      continue;
+    }
+    aiger_add_and(swept, next_lit, s, t);
+    strash.emplace(key, next_lit);
+    variable.push_back(g);
+    sig.insert(sig.end(), x, x + words);
+    classify(aiger_lit2var(next_lit));
+    lhs = next_lit;
+    next_lit += 2;
+  }
+
+  for (unsigned o = 0; o < circuit->num_outputs; ++o)
+    aiger_add_output(swept, resolve(circuit->outputs[o].lit),
+                     circuit->outputs[o].name);
+  std::cout << "Swept " << circuit->num_ands << " ands to " << swept->num_ands
+            << ": " << merged << " merged " << refuted << " refuted "
+            << undecided << " undecided\n";
+  return swept;
+}
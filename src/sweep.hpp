@@ -0,0 +1,11 @@
+#pragma once
+
+#include "aiger.h"
+
+// Functionally reduced copy of a combinatorial circuit whose ands are in
+// topological order (SAT sweeping). Candidate equivalences between ands,
+// inputs and constants are found by bit-parallel simulation and proven with
+// the incremental embedded SAT solver, each call giving up after `conflicts`
+// conflicts. Proven nodes are merged, counterexamples refine the simulation.
+// The outputs are kept in order with their names; the inputs come first.
+aiger *sweep(const aiger *circuit, unsigned conflicts);
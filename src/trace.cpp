@@ -0,0 +1,287 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "simulate.hpp"
+
+namespace {
+
+// A single witness read from a trace file.
+struct trace {
+  std::string name;
+  std::vector<std::pair<char, unsigned>> properties; // 'b' or 'j' and index
+  std::string init;                // latch values, 'x' if unconstrained
+  std::vector<std::string> inputs; // input values, one line per step
+};
+
+void set(word *w, unsigned lane) { w[lane / 64] |= word{1} << (lane % 64); }
+bool get(const word *w, unsigned lane) {
+  return w[lane / 64] >> (lane % 64) & 1;
+}
+
+word *at(std::vector<word> &values, unsigned lit) {
+  return values.data() + lanes * aiger_lit2var(lit);
+}
+
+// Reads all witnesses in an AIGER witness file.
+std::vector<trace> read_traces(const circuit *model, const char *path) {
+  std::ifstream file(path);
+  if (!file) std::cerr << "Error reading trace '" << path << "'\n", exit(1);
+  const auto num_bad =
+      (model->bad.empty() ? model->outputs : model->bad).size();
+  std::vector<trace> traces;
+  std::string line;
+  unsigned number{};
+  auto next = [&] {
+    if (!std::getline(file, line)) return false;
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    return ++number, true;
+  };
+  auto error = [&](const char *msg) {
+    std::cerr << "Error in trace '" << path << "' line " << number << ": "
+              << msg << '\n',
+        exit(1);
+  };
+  auto values = [&](std::size_t size) {
+    return line.size() == size && line.find_first_not_of("01x") == line.npos;
+  };
+  while (next()) {
+    if (line.empty() || line[0] == 'c') continue;
+    if (line != "1") error("expected status 1 of a counterexample");
+    trace &t = traces.emplace_back();
+    if (!next()) error("missing properties");
+    for (std::string_view list{line}; !list.empty();) {
+      const auto space = std::min(list.find(' '), list.size());
+      const std::string_view property = list.substr(0, space);
+      list.remove_prefix(std::min(space + 1, list.size()));
+      if (property.empty()) continue;
+      const char kind = property[0];
+      const char *end = property.data() + property.size();
+      unsigned index{};
+      const auto [ptr, err] = std::from_chars(property.data() + 1, end, index);
+      if ((kind != 'b' && kind != 'j') || err != std::errc() || ptr != end)
+        error("invalid property");
+      if (index >= (kind == 'b' ? num_bad : model->justice.size()))
+        error("property not in model");
+      t.properties.emplace_back(kind, index);
+    }
+    if (t.properties.empty()) error("missing properties");
+    if (!next()) error("missing initial state");
+    // the initial state of a model without latches may be omitted
+    bool pending = model->latches.empty() && !line.empty();
+    if (!pending && !values(model->latches.size()))
+      error("initial state does not match latches");
+    if (!pending) t.init = line;
+    while (pending || next()) {
+      pending = false;
+      if (line == ".") break;
+      if (!values(model->inputs.size())) error("step does not match inputs");
+      t.inputs.push_back(line);
+    }
+  }
+  for (unsigned i = 0; i < traces.size(); ++i) {
+    traces[i].name = path;
+    if (traces.size() > 1) traces[i].name += ':' + std::to_string(i);
+  }
+  return traces;
+}
+
+// Simulates a batch of traces in parallel, one per bit, and calls
+// `observe(active)` after each step with the traces that are still running.
+// The first step evaluates the variables in `order`, so latches are reset
+// after the gates and latches their reset points to. Traces contradicting
+// a reset are marked `inconsistent`. Afterwards `last` holds the latch
+// values following the last step of each trace.
+template <typename Observe>
+void run(const circuit *model, const std::vector<unsigned> &order,
+         const std::vector<aiger_and> &gates, const trace *batch,
+         unsigned count, word *inconsistent, std::vector<word> &last,
+         Observe observe) {
+  std::vector<word> values(lanes * (model->maxvar + 1));
+  std::vector<word> next(lanes * model->latches.size());
+  last.assign(next.size(), word{});
+  std::size_t length{};
+  for (unsigned b = 0; b < count; ++b)
+    length = std::max(length, batch[b].inputs.size());
+  auto evaluate = [&values](unsigned lhs, unsigned rhs0, unsigned rhs1) {
+    word x[lanes], y[lanes];
+    literal_words(values, rhs0, x);
+    literal_words(values, rhs1, y);
+    word *v = at(values, lhs);
+    for (unsigned w = 0; w < lanes; ++w) v[w] = x[w] & y[w];
+  };
+  for (std::size_t t = 0; t < length; ++t) {
+    word active[lanes]{}, ending[lanes]{};
+    for (unsigned l : model->inputs) std::fill_n(at(values, l), lanes, word{});
+    for (unsigned b = 0; b < count; ++b) {
+      const auto &inputs = batch[b].inputs;
+      if (t >= inputs.size()) continue;
+      set(active, b);
+      if (t + 1 == inputs.size()) set(ending, b);
+      for (std::size_t i = 0; i < model->inputs.size(); ++i)
+        if (inputs[t][i] == '1') set(at(values, model->inputs[i]), b);
+    }
+    if (t) {
+      for (std::size_t i = 0; i < model->latches.size(); ++i)
+        std::copy_n(next.data() + lanes * i, lanes,
+                    at(values, model->latches[i].lit));
+      for (const aiger_and &g : gates) evaluate(g.lhs, g.rhs0, g.rhs1);
+    } else {
+      for (unsigned v : order) {
+        const unsigned lit = aiger_var2lit(v);
+        if (const aiger_and *a = is_and(model, lit)) {
+          evaluate(a->lhs, a->rhs0, a->rhs1);
+          continue;
+        }
+        const latch *l = is_latch(model, lit);
+        if (!l) continue;
+        const auto index = static_cast<std::size_t>(l - model->latches.data());
+        const bool uninitialized = l->reset == l->lit;
+        word *value = at(values, l->lit);
+        if (uninitialized) std::fill_n(value, lanes, word{});
+        else literal_words(values, l->reset, value);
+        for (unsigned b = 0; b < count; ++b) {
+          const char c = batch[b].init.empty() ? 'x' : batch[b].init[index];
+          if (c == 'x' || !get(active, b)) continue;
+          if (uninitialized && c == '1') set(value, b);
+          else if (!uninitialized && (c == '1') != get(value, b))
+            set(inconsistent, b);
+        }
+      }
+    }
+    observe(static_cast<const word *>(active), values);
+    for (std::size_t i = 0; i < model->latches.size(); ++i) {
+      word *n = next.data() + lanes * i, *l = last.data() + lanes * i;
+      literal_words(values, model->latches[i].next, n);
+      for (unsigned w = 0; w < lanes; ++w)
+        l[w] = (l[w] & ~ending[w]) | (n[w] & ending[w]);
+    }
+  }
+}
+
+// Checks a batch of at most 64 * lanes traces, returns true if every trace
+// witnesses all its properties.
+bool check_batch(const circuit *model, const std::vector<unsigned> &order,
+                 const std::vector<aiger_and> &gates, const trace *batch,
+                 unsigned count) {
+  const auto &bad = model->bad.empty() ? model->outputs : model->bad;
+  word inconsistent[lanes]{}, constrained[lanes], looped[lanes]{};
+  std::fill_n(constrained, lanes, ~word{});
+  std::vector<word> reached(lanes * bad.size()), last;
+  run(model, order, gates, batch, count, inconsistent, last,
+      [&](const word *active, const std::vector<word> &values) {
+        word x[lanes];
+        for (unsigned l : model->constraints) {
+          literal_words(values, l, x);
+          for (unsigned w = 0; w < lanes; ++w)
+            constrained[w] &= x[w] | ~active[w];
+        }
+        for (std::size_t i = 0; i < bad.size(); ++i) {
+          literal_words(values, bad[i], x);
+          word *r = reached.data() + lanes * i;
+          for (unsigned w = 0; w < lanes; ++w)
+            r[w] |= active[w] & constrained[w] & x[w];
+        }
+      });
+
+  // Justice needs a second run, looping from the first step whose state
+  // equals the state after the last step.
+  std::vector<std::vector<word>> justified(model->justice.size());
+  std::vector<word> fair(lanes * model->fairness.size());
+  const bool justice = std::any_of(batch, batch + count, [](const trace &t) {
+    return std::any_of(t.properties.begin(), t.properties.end(),
+                       [](const auto &p) { return p.first == 'j'; });
+  });
+  if (justice) {
+    for (std::size_t j = 0; j < justified.size(); ++j)
+      justified[j].resize(lanes * model->justice[j].size());
+    const std::vector<word> final_state = last;
+    word ignored[lanes]{};
+    run(model, order, gates, batch, count, ignored, last,
+        [&](const word *active, const std::vector<word> &values) {
+          word loop[lanes], x[lanes];
+          std::copy_n(active, lanes, loop);
+          for (std::size_t i = 0; i < model->latches.size(); ++i) {
+            literal_words(values, model->latches[i].lit, x);
+            const word *f = final_state.data() + lanes * i;
+            for (unsigned w = 0; w < lanes; ++w) loop[w] &= ~(x[w] ^ f[w]);
+          }
+          for (unsigned w = 0; w < lanes; ++w)
+            loop[w] = (looped[w] |= loop[w]) & active[w];
+          auto hit = [&](unsigned lit, word *h) {
+            literal_words(values, lit, x);
+            for (unsigned w = 0; w < lanes; ++w) h[w] |= loop[w] & x[w];
+          };
+          for (std::size_t j = 0; j < justified.size(); ++j)
+            for (std::size_t k = 0; k < model->justice[j].size(); ++k)
+              hit(model->justice[j][k], justified[j].data() + lanes * k);
+          for (std::size_t i = 0; i < model->fairness.size(); ++i)
+            hit(model->fairness[i], fair.data() + lanes * i);
+        });
+  }
+
+  bool passed{true};
+  for (unsigned b = 0; b < count; ++b) {
+    const trace &t = batch[b];
+    if (get(inconsistent, b)) {
+      std::cout << "Trace " << t.name << ": initial state contradicts resets\n";
+      passed = false;
+      continue;
+    }
+    for (const auto &[kind, index] : t.properties) {
+      bool witnessed{};
+      if (kind == 'b') witnessed = get(reached.data() + lanes * index, b);
+      else {
+        witnessed = get(constrained, b) && get(looped, b);
+        const auto &hits = justified[index];
+        for (std::size_t k = 0; k < hits.size(); k += lanes)
+          witnessed = witnessed && get(hits.data() + k, b);
+        for (std::size_t k = 0; k < fair.size(); k += lanes)
+          witnessed = witnessed && get(fair.data() + k, b);
+      }
+      std::cout << "Trace " << t.name << ": " << kind << index
+                << (witnessed ? " witnessed" : " not witnessed") << " in "
+                << t.inputs.size() << " steps\n";
+      passed = passed && witnessed;
+    }
+  }
+  return passed;
+}
+
+} // namespace
+
+bool check_traces(const circuit *model, const std::vector<unsigned> &order,
+                  const std::vector<const char *> &paths) {
+  std::vector<trace> traces;
+  for (const char *path : paths) {
+    auto read = read_traces(model, path);
+    std::move(read.begin(), read.end(), std::back_inserter(traces));
+  }
+  if (traces.empty())
+    std::cerr << "Error: no counterexample in traces\n", exit(1);
+  std::cout << "Checking " << traces.size() << " traces\n";
+  std::vector<aiger_and> gates;
+  gates.reserve(model->ands.size());
+  for (unsigned v : order)
+    if (const aiger_and *a = is_and(model, aiger_var2lit(v)))
+      gates.push_back(*a);
+  bool passed{true};
+  constexpr std::size_t batch{64 * lanes};
+  for (std::size_t first = 0; first < traces.size(); first += batch) {
+    const auto count = std::min(batch, traces.size() - first);
+    passed = check_batch(model, order, gates, traces.data() + first,
+                         static_cast<unsigned>(count)) &&
+             passed;
+  }
+  std::cout << "Trace check " << (passed ? "passed" : "failed") << "\n";
+  return passed;
+}
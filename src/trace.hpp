@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+
+#include "circuit.hpp"
+
+// Checks that the AIGER witnesses (status 1) in the trace files are
+// counterexamples for the model. A bad state property is witnessed if it
+// holds in some step in which all constraints held so far. A justice
+// property is witnessed if the state after the last step repeats an earlier
+// one, all its literals and all fairness constraints hold somewhere in the
+// loop and the constraints hold throughout. Without bad state properties
+// the outputs are checked instead. `order` lists the variables of the model
+// such that ands and latches come after their inputs and resets. Up to
+// 64 * lanes traces are simulated at once, one per bit.
+bool check_traces(const circuit *model, const std::vector<unsigned> &order,
+                  const std::vector<const char *> &paths);
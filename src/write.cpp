@@ -0,0 +1,79 @@
+#include "write.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+// Writes a delta of the binary and section, 7 bits per byte, least
+// significant first.
+void delta(std::FILE *file, unsigned d) {
+  while (d & ~0x7fu) {
+    std::putc(static_cast<int>((d & 0x7f) | 0x80), file);
+    d >>= 7;
+  }
+  std::putc(static_cast<int>(d), file);
+}
+
+// Opens `path` for writing, through a gzip process if it ends with .gz.
+std::FILE *open(std::string_view path, bool piped) {
+  if (!piped) return std::fopen(std::string{path}.c_str(), "wb");
+  std::string command{"gzip -c > '"};
+  for (char c : path)
+    if (c == '\'') command += "'\\''";
+    else command += c;
+  command += '\'';
+  return popen(command.c_str(), "w");
+}
+
+} // namespace
+
+bool write_aiger(const aiger *circuit, const char *path,
+                 const std::vector<unsigned> &outputs,
+                 const std::vector<bool> *cone) {
+  auto included = [cone](unsigned lit) {
+    return !cone || (*cone)[aiger_lit2var(lit)];
+  };
+  std::vector<unsigned> lits(circuit->maxvar + 1);
+  unsigned inputs{}, ands{};
+  for (unsigned i = 0; i < circuit->num_inputs; ++i)
+    if (included(circuit->inputs[i].lit))
+      lits[aiger_lit2var(circuit->inputs[i].lit)] = 2 * ++inputs;
+  for (unsigned i = 0; i < circuit->num_ands; ++i)
+    if (included(circuit->ands[i].lhs))
+      lits[aiger_lit2var(circuit->ands[i].lhs)] = 2 * (inputs + ++ands);
+  auto resolve = [&lits](unsigned l) {
+    return lits[aiger_lit2var(l)] ^ aiger_sign(l);
+  };
+
+  const std::string_view name{path};
+  const bool piped = name.ends_with(".gz");
+  const bool binary = !name.ends_with(piped ? ".aag.gz" : ".aag");
+  std::FILE *file = open(name, piped);
+  if (!file) return false;
+  std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+  std::fprintf(file, "%s %u %u 0 %zu %u\n", binary ? "aig" : "aag",
+               inputs + ands, inputs, outputs.size(), ands);
+  if (!binary)
+    for (unsigned i = 1; i <= inputs; ++i) std::fprintf(file, "%u\n", 2 * i);
+  for (unsigned o : outputs)
+    std::fprintf(file, "%u\n", resolve(circuit->outputs[o].lit));
+  for (unsigned i = 0; i < circuit->num_ands; ++i) {
+    const aiger_and *a = circuit->ands + i;
+    if (!included(a->lhs)) continue;
+    const unsigned lhs = resolve(a->lhs);
+    unsigned s = resolve(a->rhs0), t = resolve(a->rhs1);
+    if (s < t) std::swap(s, t);
+    assert(lhs > s);
+    if (binary) delta(file, lhs - s), delta(file, s - t);
+    else std::fprintf(file, "%u %u %u\n", lhs, s, t);
+  }
+  for (std::size_t o = 0; o < outputs.size(); ++o)
+    if (const char *symbol = circuit->outputs[outputs[o]].name)
+      std::fprintf(file, "o%zu %s\n", o, symbol);
+  const bool failed = std::ferror(file);
+  return !(piped ? pclose(file) : std::fclose(file)) && !failed;
+}
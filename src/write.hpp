@@ -0,0 +1,15 @@
+#pragma once
+
+#include <vector>
+
+#include "aiger.h"
+
+// Streams the outputs listed by index in `outputs` of a combinatorial circuit
+// whose ands are in topological order to an AIGER file, binary unless `path`
+// ends with .aag, and compressed by gzip if it ends with .gz. With `cone`,
+// only the inputs and ands it marks are written. Inputs and ands are
+// renumbered densely in circuit order on the fly, so unlike the library no
+// reencoded copy of the circuit is built. Returns false on failure.
+bool write_aiger(const aiger *circuit, const char *path,
+                 const std::vector<unsigned> &outputs,
+                 const std::vector<bool> *cone = nullptr);